@@ -0,0 +1,756 @@
+/* ============================================================================
+ *  BlockCache.c: Cached interpreter (predecoded basic blocks).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "BlockCache.h"
+#include "CP0.h"
+#include "CPU.h"
+#include "DCStage.h"
+#include "Decoder.h"
+#include "EXStage.h"
+#include "Externs.h"
+#include "Fault.h"
+#include "IdleLoop.h"
+#include "Pipeline.h"
+#include "Recompiler.h"
+#include "Region.h"
+#include "StaticRecompiler.h"
+#include "TLB.h"
+#include "WBStage.h"
+
+#ifdef __cplusplus
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#else
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+static void BuildBlock(struct VR4300 *, struct VR4300Block *, uint32_t);
+static void DrainPipeline(struct VR4300 *);
+static bool ExecuteDelaySlot(struct VR4300 *);
+static bool ExecuteFused(struct VR4300 *,
+  const struct VR4300BlockInstruction *);
+static bool ExecuteInstruction(struct VR4300 *,
+  const struct VR4300BlockInstruction *);
+static void ExecuteNative(struct VR4300 *,
+  const struct VR4300BlockInstruction *);
+static void FlushPipeline(struct VR4300 *);
+static enum VR4300Fusion FuseInstructions(
+  const struct VR4300BlockInstruction *);
+static uint64_t IssueInstruction(struct VR4300 *,
+  const struct VR4300BlockInstruction *);
+static const struct VR4300Block *LookupBlock(struct VR4300 *, uint64_t);
+static void RetireInstruction(struct VR4300 *,
+  const struct VR4300BlockInstruction *);
+static bool RetireStages(struct VR4300 *, uint64_t);
+static void RunBlock(struct VR4300 *, const struct VR4300Block *);
+static bool TranslatePC(struct VR4300 *, uint64_t, uint32_t *);
+
+/* ============================================================================
+ *  BuildBlock: Fetches and decodes a basic block, up to and including the
+ *  delay slot of the first branch. Blocks never cross a physical page.
+ * ========================================================================= */
+static void
+BuildBlock(struct VR4300 *vr4300, struct VR4300Block *block, uint32_t paddr) {
+  struct VR4300BlockCache *cache = &vr4300->blockCache;
+  unsigned limit = (0x1000 - (paddr & 0xFFF)) >> 2;
+  bool delaySlot = false;
+  unsigned i;
+
+  if (limit > VR4300_BLOCK_MAX_LENGTH)
+    limit = VR4300_BLOCK_MAX_LENGTH;
+
+  for (i = 0; i < limit; i++) {
+    struct VR4300BlockInstruction *instruction = block->code + i;
+
+    instruction->iw = VR4300PageReadWord(
+      &vr4300->pageTable, paddr + (i << 2));
+    instruction->opcode = *VR4300DecodeInstruction(instruction->iw);
+    instruction->fusion = VR4300_FUSION_NONE;
+    instruction->native = NULL;
+
+    VR4300DecodeOperands(instruction->iw, &instruction->operands);
+
+    if (delaySlot) {
+      delaySlot = false;
+      i++;
+      break;
+    }
+
+    delaySlot = (instruction->opcode.flags & OPCODE_INFO_BRANCH) != 0;
+  }
+
+  block->paddr = paddr;
+  block->length = i;
+  block->splitDelaySlot = delaySlot;
+
+  /* Tag the pairs that can be dispatched together. */
+  for (i = 0; i + 1 < block->length; i++) {
+    if ((block->code[i].fusion = FuseInstructions(block->code + i)) !=
+      VR4300_FUSION_NONE)
+      i++;
+  }
+
+  if (vr4300->staticCode.runs != NULL)
+    VR4300AttachStaticCode(vr4300, block);
+
+  /* Might flush the cache (and bump the generation) to make room. */
+  if (vr4300->recompiler.enabled)
+    VR4300RecompileBlock(vr4300, block);
+
+  block->generation = cache->generation;
+
+  VR4300MarkCodePage(cache->codePages, paddr);
+}
+
+/* ============================================================================
+ *  DrainPipeline: Retires everything that's in flight in the pipeline, so
+ *  that execution can continue one instruction at a time.
+ * ========================================================================= */
+static void
+DrainPipeline(struct VR4300 *vr4300) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300FaultManager *manager = &pipeline->faultManager;
+  bool branch;
+
+  /* Let any stalls and exceptions resolve themselves. */
+  do {
+#ifdef DO_FASTFORWARD
+    if (manager->excpIndex == VR4300_PCU_FASTFORWARD) {
+      manager->excpIndex = VR4300_PCU_NORMAL;
+      manager->faulting = manager->ilIndex != VR4300_PCU_NORMAL;
+    }
+#endif
+
+    if (manager->faulting)
+      CycleVR4300(vr4300);
+  } while (manager->faulting);
+
+  /* Retire whatever is in DC/WB. */
+  VR4300WBStage(vr4300);
+  VR4300DCStage(vr4300);
+  VR4300WBStage(vr4300);
+
+  /* Retire whatever is in EX; IC/RF are refetched. */
+  branch = (pipeline->rfexLatch.opcode.flags & OPCODE_INFO_BRANCH) != 0;
+  VR4300EXStage(vr4300);
+
+  if (manager->faulting && manager->excpIndex != VR4300_PCU_NORMAL
+#ifdef DO_FASTFORWARD
+    && manager->excpIndex != VR4300_PCU_FASTFORWARD
+#endif
+    ) {
+    HandleExceptions(vr4300);
+    return;
+  }
+
+  VR4300DCStage(vr4300);
+  VR4300WBStage(vr4300);
+
+  if (branch)
+    ExecuteDelaySlot(vr4300);
+}
+
+/* ============================================================================
+ *  ExecuteDelaySlot: Executes the delay slot of the branch that was just
+ *  executed when it couldn't be included in the branch's block.
+ * ========================================================================= */
+static bool
+ExecuteDelaySlot(struct VR4300 *vr4300) {
+  struct VR4300BlockInstruction delaySlot;
+  uint32_t paddr;
+
+  if (!TranslatePC(vr4300, vr4300->pipeline.rfexLatch.pc + 4, &paddr))
+    return false;
+
+  delaySlot.iw = VR4300PageReadWord(&vr4300->pageTable, paddr);
+  delaySlot.opcode = *VR4300DecodeInstruction(delaySlot.iw);
+  VR4300DecodeOperands(delaySlot.iw, &delaySlot.operands);
+  ExecuteInstruction(vr4300, &delaySlot);
+  return true;
+}
+
+/* ============================================================================
+ *  ExecuteFused: Runs a fused pair of instructions. The first one only ever
+ *  writes a register, so it's retired on the spot; the second one is too
+ *  if it can be, and goes through EX/DC/WB otherwise.
+ * ========================================================================= */
+static bool
+ExecuteFused(struct VR4300 *vr4300,
+  const struct VR4300BlockInstruction *instruction) {
+  vr4300->blockCache.fusions[instruction->fusion]++;
+  RetireInstruction(vr4300, instruction);
+
+  switch (instruction->fusion) {
+    case VR4300_FUSION_LUI_ORI:
+    case VR4300_FUSION_LUI_ADDIU:
+      RetireInstruction(vr4300, instruction + 1);
+      return true;
+
+    default:
+      break;
+  }
+
+  return ExecuteInstruction(vr4300, instruction + 1);
+}
+
+/* ============================================================================
+ *  ExecuteInstruction: Runs a predecoded instruction through RF, EX, DC and
+ *  WB back-to-back. Returns false if control left the block (exceptions,
+ *  ERET, ...); branches are resolved after their delay slot instead.
+ * ========================================================================= */
+static bool
+ExecuteInstruction(struct VR4300 *vr4300,
+  const struct VR4300BlockInstruction *instruction) {
+  uint64_t pc = IssueInstruction(vr4300, instruction);
+
+  VR4300EXStage(vr4300);
+  return RetireStages(vr4300, pc);
+}
+
+/* ============================================================================
+ *  ExecuteNative: Runs a recompiled run of instructions. Each instruction is
+ *  accounted a single PCycle, exactly as if it had been interpreted.
+ * ========================================================================= */
+static void
+ExecuteNative(struct VR4300 *vr4300,
+  const struct VR4300BlockInstruction *instruction) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300ICRFLatch *icrfLatch = &pipeline->icrfLatch;
+  unsigned length = instruction->nativeLength;
+
+  instruction->native(vr4300->regs);
+
+  pipeline->rfexLatch.pc = icrfLatch->pc + ((length - 1) << 2);
+  icrfLatch->pc += length << 2;
+  pipeline->cycles += length;
+
+  /* The registers changed behind the latches' back; don't forward. */
+  pipeline->exdcLatch.result.dest = 0;
+  pipeline->dcwbLatch.result.dest = 0;
+}
+
+/* ============================================================================
+ *  FlushPipeline: Hands control back to the cycle-accurate pipeline. The
+ *  latches are left as they would be after an exception: the RF slot is
+ *  killed, and IC refetches from the next PC.
+ * ========================================================================= */
+static void
+FlushPipeline(struct VR4300 *vr4300) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300ICRFLatch *icrfLatch = &pipeline->icrfLatch;
+  const struct RegionInfo *region;
+
+#ifdef DO_FASTFORWARD
+  struct VR4300FaultManager *manager = &pipeline->faultManager;
+
+  if (manager->excpIndex == VR4300_PCU_FASTFORWARD) {
+    manager->excpIndex = VR4300_PCU_NORMAL;
+    manager->faulting = manager->ilIndex != VR4300_PCU_NORMAL;
+  }
+#endif
+
+  memset(&pipeline->dcwbLatch.result, 0, sizeof(pipeline->dcwbLatch.result));
+  memset(&pipeline->exdcLatch.result, 0, sizeof(pipeline->exdcLatch.result));
+  pipeline->exdcLatch.memoryData.function = NULL;
+  VR4300InvalidateOpcode(&pipeline->rfexLatch.opcode);
+
+  if (icrfLatch->iwMask) {
+    icrfLatch->iwMask = 0;
+    icrfLatch->pc -= 4;
+  }
+
+  if ((region = VR4300LookupRegion(vr4300, icrfLatch->pc)) != NULL) {
+    icrfLatch->address = icrfLatch->pc - region->offset;
+    icrfLatch->region = region;
+  }
+}
+
+/* ============================================================================
+ *  FuseInstructions: Returns the kind of pair an instruction starts, if the
+ *  following instruction consumes its result.
+ * ========================================================================= */
+static enum VR4300Fusion
+FuseInstructions(const struct VR4300BlockInstruction *instruction) {
+  const struct VR4300BlockInstruction *next = instruction + 1;
+  unsigned dest;
+
+  switch (instruction->opcode.id) {
+    case VR4300_OPCODE_LUI:
+      if ((dest = instruction->operands.rt) == VR4300_REGISTER_ZERO ||
+        next->operands.rs != dest)
+        break;
+
+      if (next->opcode.id == VR4300_OPCODE_ORI)
+        return VR4300_FUSION_LUI_ORI;
+
+      else if (next->opcode.id == VR4300_OPCODE_ADDI_SUBI_ADDIU_SUBIU)
+        return VR4300_FUSION_LUI_ADDIU;
+
+      else if (next->opcode.id == VR4300_OPCODE_LW)
+        return VR4300_FUSION_LUI_LW;
+
+      break;
+
+    case VR4300_OPCODE_SLT:
+    case VR4300_OPCODE_SLTU:
+      dest = instruction->operands.rd;
+      /* Fallthrough. */
+
+    case VR4300_OPCODE_SLTI:
+    case VR4300_OPCODE_SLTIU:
+      if (instruction->opcode.id == VR4300_OPCODE_SLTI ||
+        instruction->opcode.id == VR4300_OPCODE_SLTIU)
+        dest = instruction->operands.rt;
+
+      if (dest != VR4300_REGISTER_ZERO &&
+        next->opcode.id == VR4300_OPCODE_BEQ_BEQL_BNE_BNEL &&
+        (next->operands.rs == dest || next->operands.rt == dest))
+        return VR4300_FUSION_SLT_BRANCH;
+
+      break;
+
+    default:
+      break;
+  }
+
+  return VR4300_FUSION_NONE;
+}
+
+/* ============================================================================
+ *  IssueInstruction: Latches a predecoded instruction into RF/EX, ready for
+ *  EX, and returns the PC that it falls through to.
+ * ========================================================================= */
+static uint64_t
+IssueInstruction(struct VR4300 *vr4300,
+  const struct VR4300BlockInstruction *instruction) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300ICRFLatch *icrfLatch = &pipeline->icrfLatch;
+  struct VR4300RFEXLatch *rfexLatch = &pipeline->rfexLatch;
+
+  /* Branch likely instructions kill the delay slot via iwMask. */
+  rfexLatch->iw = instruction->iw & icrfLatch->iwMask;
+  rfexLatch->opcode.id = (enum VR4300OpcodeID)
+    (instruction->opcode.id & icrfLatch->iwMask);
+  rfexLatch->opcode.flags = instruction->opcode.flags & icrfLatch->iwMask;
+  rfexLatch->operands = instruction->operands;
+  rfexLatch->pc = icrfLatch->pc;
+  icrfLatch->pc += 4;
+  icrfLatch->iwMask = ~0;
+
+  pipeline->cycles++;
+  return icrfLatch->pc;
+}
+
+/* ============================================================================
+ *  LookupBlock: Returns the block that starts at the given virtual address,
+ *  building it first if needed. Returns NULL if the PC can't be fetched.
+ * ========================================================================= */
+static const struct VR4300Block *
+LookupBlock(struct VR4300 *vr4300, uint64_t pc) {
+  struct VR4300BlockCache *cache = &vr4300->blockCache;
+  struct VR4300Block *block;
+  uint32_t paddr;
+
+  if (!TranslatePC(vr4300, pc, &paddr))
+    return NULL;
+
+  block = cache->blocks + (paddr >> 2 & (VR4300_BLOCK_CACHE_SIZE - 1));
+
+  if (unlikely(block->paddr != paddr || !block->length ||
+    block->generation != cache->generation))
+    BuildBlock(vr4300, block, paddr);
+
+  return block;
+}
+
+/* ============================================================================
+ *  RetireInstruction: Runs an instruction that only writes a register
+ *  straight through its handler, skipping the DC and WB stages. The latches
+ *  are left just as if it had gone through the whole pipeline.
+ * ========================================================================= */
+static void
+RetireInstruction(struct VR4300 *vr4300,
+  const struct VR4300BlockInstruction *instruction) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300ICRFLatch *icrfLatch = &pipeline->icrfLatch;
+  struct VR4300RFEXLatch *rfexLatch = &pipeline->rfexLatch;
+  struct VR4300EXDCLatch *exdcLatch = &pipeline->exdcLatch;
+  struct VR4300DCWBLatch *dcwbLatch = &pipeline->dcwbLatch;
+  uint64_t rs, rt;
+
+  rfexLatch->iw = instruction->iw;
+  rfexLatch->opcode = instruction->opcode;
+  rfexLatch->operands = instruction->operands;
+  rfexLatch->pc = icrfLatch->pc;
+  icrfLatch->pc += 4;
+  pipeline->cycles++;
+
+  /* Results have already been written back; no forwarding needed. */
+  vr4300->regs[VR4300_REGISTER_ZERO] = 0;
+  rs = vr4300->regs[instruction->operands.rs];
+  rt = vr4300->regs[instruction->operands.rt];
+  exdcLatch->result.dest = 0;
+
+  switch (instruction->opcode.id) {
+    case VR4300_OPCODE_ADDI_SUBI_ADDIU_SUBIU:
+      VR4300ADDI_SUBI_ADDIU_SUBIU(vr4300, rs, rt);
+      break;
+
+    case VR4300_OPCODE_LUI: VR4300LUI(vr4300, rs, rt); break;
+    case VR4300_OPCODE_ORI: VR4300ORI(vr4300, rs, rt); break;
+    case VR4300_OPCODE_SLT: VR4300SLT(vr4300, rs, rt); break;
+    case VR4300_OPCODE_SLTI: VR4300SLTI(vr4300, rs, rt); break;
+    case VR4300_OPCODE_SLTIU: VR4300SLTIU(vr4300, rs, rt); break;
+    case VR4300_OPCODE_SLTU: VR4300SLTU(vr4300, rs, rt); break;
+
+    default:
+      assert(0 && "Instruction can't be retired early.");
+      break;
+  }
+
+  exdcLatch->result.flags = instruction->opcode.flags;
+  dcwbLatch->result.dest = exdcLatch->result.dest;
+  dcwbLatch->result.data = exdcLatch->result.data;
+  vr4300->regs[dcwbLatch->result.dest] = dcwbLatch->result.data;
+}
+
+/* ============================================================================
+ *  RetireStages: Finishes an instruction once EX has run it, taking it
+ *  through DC and WB. Returns false if control left the block (exceptions,
+ *  ERET, ...), judging by whether the PC is still where issuing left it.
+ * ========================================================================= */
+static bool
+RetireStages(struct VR4300 *vr4300, uint64_t pc) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300FaultManager *manager = &pipeline->faultManager;
+
+  /* The faulting instruction doesn't make it to DC/WB. */
+  if (unlikely(manager->faulting)) {
+    if (manager->excpIndex != VR4300_PCU_NORMAL
+#ifdef DO_FASTFORWARD
+      && manager->excpIndex != VR4300_PCU_FASTFORWARD
+#endif
+      ) {
+      HandleExceptions(vr4300);
+      return false;
+    }
+  }
+
+  VR4300DCStage(vr4300);
+  VR4300WBStage(vr4300);
+
+  if (unlikely(manager->ilIndex != VR4300_PCU_NORMAL)) {
+    pipeline->cycles += pipeline->stalls;
+    pipeline->stalls = 0;
+
+    HandleInterlocks(vr4300);
+  }
+
+  return pipeline->icrfLatch.pc == pc ||
+    (pipeline->rfexLatch.opcode.flags & OPCODE_INFO_BRANCH);
+}
+
+#if defined(USE_COMPUTED_GOTO) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+#ifndef NDEBUG
+#define COUNT_OPCODE() (VR4300OpcodeCounts[pipeline->rfexLatch.opcode.id]++)
+#else
+#define COUNT_OPCODE() ((void) 0)
+#endif
+
+/* Picks the label for the next instruction, and jumps to it. Stores */
+/* can invalidate the running block, so its length is read every time. */
+#define DISPATCH() \
+  do { \
+    if (unlikely(instruction >= block->code + block->length)) \
+      goto Finished; \
+\
+    if (unlikely(instruction->native != NULL || \
+      instruction->fusion != VR4300_FUSION_NONE) && icrfLatch->iwMask) \
+      goto ExecuteSpecial; \
+\
+    goto *handlers[instruction->opcode.id & icrfLatch->iwMask]; \
+  } while (0)
+
+/* ============================================================================
+ *  RunBlock: Executes a block, up to wherever control leaves it. Each
+ *  opcode gets its own label, with its handler called directly, and each
+ *  label dispatches the next instruction itself: the indirect jumps are
+ *  spread out, so the host can predict them from which opcode came before.
+ * ========================================================================= */
+static void
+RunBlock(struct VR4300 *vr4300, const struct VR4300Block *block) {
+  static const void *const handlers[NUM_VR4300_OPCODES] = {
+#define X(op) &&Execute##op,
+#include "Opcodes.md"
+#undef X
+  };
+
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  const struct VR4300ICRFLatch *icrfLatch = &pipeline->icrfLatch;
+  const struct VR4300BlockInstruction *instruction = block->code;
+  uint64_t pc, rs, rt;
+
+  DISPATCH();
+
+  /* A killed delay slot has to go through the interpreter. */
+ExecuteSpecial:
+  if (instruction->native != NULL) {
+    ExecuteNative(vr4300, instruction);
+    instruction += instruction->nativeLength;
+    DISPATCH();
+  }
+
+  if (!ExecuteFused(vr4300, instruction))
+    return;
+
+  instruction += 2;
+  DISPATCH();
+
+#define X(op) \
+Execute##op: \
+  pc = IssueInstruction(vr4300, instruction++); \
+  VR4300ForwardOperands(vr4300, &rs, &rt); \
+  COUNT_OPCODE(); \
+  VR4300##op(vr4300, rs, rt); \
+  pipeline->exdcLatch.result.flags = pipeline->rfexLatch.opcode.flags; \
+\
+  if (!RetireStages(vr4300, pc)) \
+    return; \
+\
+  DISPATCH();
+#include "Opcodes.md"
+#undef X
+
+Finished:
+  if (instruction == block->code + block->length && block->splitDelaySlot)
+    ExecuteDelaySlot(vr4300);
+}
+
+#undef COUNT_OPCODE
+#undef DISPATCH
+#pragma GCC diagnostic pop
+
+#else
+/* ============================================================================
+ *  RunBlock: Executes a block, up to wherever control leaves it.
+ * ========================================================================= */
+static void
+RunBlock(struct VR4300 *vr4300, const struct VR4300Block *block) {
+  const struct VR4300ICRFLatch *icrfLatch = &vr4300->pipeline.icrfLatch;
+  unsigned i;
+
+  for (i = 0; i < block->length; i++) {
+
+    /* A killed delay slot has to go through the interpreter. */
+    if (block->code[i].native != NULL && icrfLatch->iwMask) {
+      ExecuteNative(vr4300, block->code + i);
+      i += block->code[i].nativeLength - 1;
+      continue;
+    }
+
+    if (block->code[i].fusion != VR4300_FUSION_NONE &&
+      icrfLatch->iwMask) {
+      if (!ExecuteFused(vr4300, block->code + i++))
+        return;
+
+      continue;
+    }
+
+    if (!ExecuteInstruction(vr4300, block->code + i))
+      return;
+  }
+
+  if (i == block->length && block->splitDelaySlot)
+    ExecuteDelaySlot(vr4300);
+}
+#endif
+
+/* ============================================================================
+ *  TranslatePC: Translates a virtual address for an instruction fetch.
+ * ========================================================================= */
+static bool
+TranslatePC(struct VR4300 *vr4300, uint64_t vaddr, uint32_t *paddr) {
+  const struct RegionInfo *region;
+
+  if ((region = VR4300LookupRegion(vr4300, vaddr)) == NULL) {
+    debug("Unimplemented fault: VR4300_FAULT_IADE.");
+    return false;
+  }
+
+  vaddr -= region->offset;
+  *paddr = vaddr;
+
+  if (region->mapped && !VR4300TranslateCode(vr4300, vaddr, paddr)) {
+    debugarg("TLB Miss: Address: 0x%.16lX.", vaddr);
+    debug("Unimplemented fault: VR4300_TLB_...");
+  }
+
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300DestroyBlockCache: Releases the blocks.
+ * ========================================================================= */
+void
+VR4300DestroyBlockCache(struct VR4300BlockCache *cache) {
+  free(cache->blocks);
+  cache->blocks = NULL;
+}
+
+/* ============================================================================
+ *  VR4300FlushBlocks: Invalidates every block in the cache.
+ * ========================================================================= */
+void
+VR4300FlushBlocks(struct VR4300BlockCache *cache) {
+  unsigned i;
+
+  if (cache->blocks == NULL)
+    return;
+
+  /* Only walk the blocks when the generation wraps around. */
+  if (++cache->generation == 0) {
+    for (i = 0; i < VR4300_BLOCK_CACHE_SIZE; i++)
+      cache->blocks[i].length = 0;
+  }
+}
+
+/* ============================================================================
+ *  VR4300InitBlockCache: Initializes the block cache. Blocks are allocated
+ *  the first time VR4300RunCached is invoked.
+ * ========================================================================= */
+void
+VR4300InitBlockCache(struct VR4300BlockCache *cache) {
+  debug("Initializing BlockCache.");
+  memset(cache, 0, sizeof(*cache));
+}
+
+/* ============================================================================
+ *  VR4300InvalidateBlocks: Invalidates any block that covers the range.
+ * ========================================================================= */
+void
+VR4300InvalidateBlocks(struct VR4300BlockCache *cache,
+  uint32_t paddr, uint32_t length) {
+  uint32_t address, end = paddr + length;
+  unsigned i;
+
+  if (cache->blocks == NULL)
+    return;
+
+  /* Cheaper to check every block than every word of a big range. */
+  if (length >= VR4300_BLOCK_CACHE_SIZE << 2) {
+    for (i = 0; i < VR4300_BLOCK_CACHE_SIZE; i++) {
+      struct VR4300Block *block = cache->blocks + i;
+
+      if (block->paddr - paddr < length ||
+        paddr - block->paddr < block->length << 2)
+        block->length = 0;
+    }
+
+    return;
+  }
+
+  /* Blocks don't cross pages; look back for any that cover each word. */
+  for (address = paddr & ~0x3U; address < end; address += 4) {
+    /* Skip the rest of any page that nothing was decoded from. */
+    if (address < VR4300_CODE_LIMIT &&
+      !VR4300IsCodePage(cache->codePages, address)) {
+      address = (address | 0xFFF) - 3;
+      continue;
+    }
+
+    for (i = 0; i < VR4300_BLOCK_MAX_LENGTH && (i << 2) <=
+      (address & 0xFFF); i++) {
+      uint32_t start = address - (i << 2);
+      struct VR4300Block *block = cache->blocks +
+        (start >> 2 & (VR4300_BLOCK_CACHE_SIZE - 1));
+
+      if (block->paddr == start && block->length > i)
+        block->length = 0;
+    }
+  }
+}
+
+/* ============================================================================
+ *  VR4300RunCached: Like VR4300Run, but executes predecoded basic blocks one
+ *  instruction at a time instead of cycling the pipeline. Each instruction
+ *  is accounted a single PCycle (plus any interlock stalls), and interrupts
+ *  are only taken at block boundaries, so timing is only approximate.
+ * ========================================================================= */
+unsigned long long
+VR4300RunCached(struct VR4300 *vr4300, unsigned long long cycles) {
+  struct VR4300BlockCache *cache = &vr4300->blockCache;
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300FaultManager *manager = &pipeline->faultManager;
+  struct VR4300ICRFLatch *icrfLatch = &pipeline->icrfLatch;
+  unsigned long long start = pipeline->cycles;
+  const struct VR4300Block *block;
+
+  if (cache->blocks == NULL && (cache->blocks = (struct VR4300Block*)
+    calloc(VR4300_BLOCK_CACHE_SIZE, sizeof(*cache->blocks))) == NULL) {
+    debug("Failed to allocate memory.");
+    return VR4300Run(vr4300, cycles);
+  }
+
+  pipeline->runUntil = start + cycles;
+  DrainPipeline(vr4300);
+
+  while (pipeline->cycles < pipeline->runUntil) {
+
+    /* ERET and exceptions kill the following instruction. */
+    if (!icrfLatch->iwMask) {
+      icrfLatch->iwMask = ~0;
+      icrfLatch->pc += 4;
+      pipeline->cycles++;
+    }
+
+    if (unlikely(pipeline->cycles >= vr4300->cp0.compareCycle))
+      VR4300RaiseTimerInterrupt(vr4300);
+
+#ifdef DO_FASTFORWARD
+    if (manager->excpIndex == VR4300_PCU_FASTFORWARD) {
+      manager->excpIndex = VR4300_PCU_NORMAL;
+      manager->faulting = manager->ilIndex != VR4300_PCU_NORMAL;
+
+      if (!vr4300->cp0.interruptPending)
+        VR4300SkipToNextEvent(vr4300);
+    }
+#endif
+
+    if (unlikely(vr4300->cp0.interruptPending)) {
+      QueueException(manager, VR4300_FAULT_INTR, icrfLatch->pc,
+        0, 0 /* No Data */, VR4300_PCU_START_RF);
+
+      HandleExceptions(vr4300);
+      continue;
+    }
+
+    if ((block = LookupBlock(vr4300, icrfLatch->pc)) == NULL)
+      break;
+
+    RunBlock(vr4300, block);
+  }
+
+#ifdef DO_FASTFORWARD
+  VR4300LeaveIdleLoop(vr4300);
+#endif
+
+  FlushPipeline(vr4300);
+  VR4300DrainWriteBuffer(&vr4300->pageTable);
+  pipeline->runUntil = 0;
+  return pipeline->cycles - start;
+}
+
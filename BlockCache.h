@@ -0,0 +1,75 @@
+/* ============================================================================
+ *  BlockCache.h: Cached interpreter (predecoded basic blocks).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__BLOCKCACHE_H__
+#define __VR4300__BLOCKCACHE_H__
+#include "Common.h"
+#include "CodePages.h"
+#include "Decoder.h"
+
+#define VR4300_BLOCK_CACHE_SIZE 4096
+#define VR4300_BLOCK_MAX_LENGTH 32
+
+typedef void (*VR4300NativeCode)(uint64_t *);
+
+/* Pairs of instructions that are dispatched together. */
+enum VR4300Fusion {
+  VR4300_FUSION_NONE,
+  VR4300_FUSION_LUI_ORI,
+  VR4300_FUSION_LUI_ADDIU,
+  VR4300_FUSION_LUI_LW,
+  VR4300_FUSION_SLT_BRANCH,
+  NUM_VR4300_FUSIONS
+};
+
+struct VR4300BlockInstruction {
+  struct VR4300Opcode opcode;
+  struct VR4300Operands operands;
+  uint32_t iw;
+
+  /* Set on the first instruction of a fused pair. */
+  enum VR4300Fusion fusion;
+
+  /* Recompiled run of instructions starting here, if any. */
+  unsigned nativeLength;
+  VR4300NativeCode native;
+};
+
+struct VR4300Block {
+  uint32_t paddr;
+  unsigned length;
+  unsigned generation;
+  bool splitDelaySlot;
+
+  struct VR4300BlockInstruction code[VR4300_BLOCK_MAX_LENGTH];
+};
+
+struct VR4300BlockCache {
+  struct VR4300Block *blocks;
+  unsigned generation;
+
+  /* Number of times each fused pair was executed. */
+  unsigned long long fusions[NUM_VR4300_FUSIONS];
+
+  /* Shared with the predecode cache; owned by the CPU. */
+  struct VR4300CodePages *codePages;
+};
+
+struct VR4300;
+
+void VR4300InitBlockCache(struct VR4300BlockCache *);
+void VR4300DestroyBlockCache(struct VR4300BlockCache *);
+void VR4300FlushBlocks(struct VR4300BlockCache *);
+void VR4300InvalidateBlocks(struct VR4300BlockCache *, uint32_t, uint32_t);
+
+unsigned long long VR4300RunCached(struct VR4300 *, unsigned long long);
+
+#endif
+
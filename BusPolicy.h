@@ -0,0 +1,199 @@
+/* ============================================================================
+ *  BusPolicy.h: Compile-time binding of the memory functions to a bus.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__BUSPOLICY_H__
+#define __VR4300__BUSPOLICY_H__
+#include "Common.h"
+#include "Externs.h"
+#include "Fastmem.h"
+#include "PageTable.h"
+#include "WriteBuffer.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+/* ============================================================================
+ *  VR4300PageBusRead: Reads from a physical address through fastmem, the
+ *  page table or the bus, in that order. Contents are in host byte order.
+ *  Returns false (leaving the contents alone) if nothing is mapped there.
+ * ========================================================================= */
+static inline bool
+VR4300PageBusRead(const struct VR4300PageTable *pages,
+  unsigned type, uint32_t address, void *contents) {
+  MemoryFunction read;
+  void *opaque;
+
+  /* Uncached loads see every store before them. */
+  if (pages->writeBuffer->count)
+    VR4300DrainWriteBuffer(pages);
+
+  if (pages->fastmem != NULL && type != BUS_TYPE_UWORD) {
+    const uint8_t *host = pages->fastmem + address;
+    uint16_t hword;
+    uint32_t word;
+    uint64_t dword;
+    uint8_t byte;
+
+    switch (type) {
+      case BUS_TYPE_BYTE:
+        byte = VR4300FastmemLoad8(host);
+        memcpy(contents, &byte, sizeof(byte));
+        break;
+
+      case BUS_TYPE_HWORD:
+        hword = VR4300FastmemLoad16(host);
+        memcpy(contents, &hword, sizeof(hword));
+        break;
+
+      case BUS_TYPE_WORD:
+        word = VR4300FastmemLoad32(host);
+        memcpy(contents, &word, sizeof(word));
+        break;
+
+      default:
+        dword = VR4300FastmemLoad64(host);
+        memcpy(contents, &dword, sizeof(dword));
+        break;
+    }
+
+    return true;
+  }
+
+  if ((read = VR4300PageRead(pages, type, address, &opaque)) == NULL)
+    return false;
+
+  read(opaque, address, contents);
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300PageBusWrite: Writes to a physical address through fastmem, the
+ *  write buffer or the page table and bus, in that order. Contents are in
+ *  host byte order, or a struct UnalignedData for BUS_TYPE_UWORD/UDWORD.
+ * ========================================================================= */
+static inline bool
+VR4300PageBusWrite(const struct VR4300PageTable *pages,
+  unsigned type, uint32_t address, const void *contents) {
+  MemoryFunction write;
+  void *opaque;
+
+  if (pages->fastmem != NULL && type != BUS_TYPE_UWORD) {
+    uint8_t *host = pages->fastmem + address;
+    uint16_t hword;
+    uint32_t word;
+    uint64_t dword;
+    uint8_t byte;
+
+    /* Partial stores are still buffered; don't land ahead of them. */
+    if (pages->writeBuffer->count)
+      VR4300DrainWriteBuffer(pages);
+
+    switch (type) {
+      case BUS_TYPE_BYTE:
+        memcpy(&byte, contents, sizeof(byte));
+        VR4300FastmemStore8(host, byte);
+        break;
+
+      case BUS_TYPE_HWORD:
+        memcpy(&hword, contents, sizeof(hword));
+        VR4300FastmemStore16(host, hword);
+        break;
+
+      case BUS_TYPE_WORD:
+        memcpy(&word, contents, sizeof(word));
+        VR4300FastmemStore32(host, word);
+        break;
+
+      default:
+        memcpy(&dword, contents, sizeof(dword));
+        VR4300FastmemStore64(host, dword);
+        break;
+    }
+
+    return true;
+  }
+
+  /* Stores to RDRAM are buffered; anything else (e.g., MMIO that */
+  /* might start a DMA) waits for everything ahead of it first. */
+  if (address < VR4300_RDRAM_END) {
+    VR4300BufferStore(pages, type, address, contents);
+    return true;
+  }
+
+  if (pages->writeBuffer->count)
+    VR4300DrainWriteBuffer(pages);
+
+  if ((write = VR4300PageWrite(pages, type, address, &opaque)) == NULL)
+    return false;
+
+  write(opaque, address, (void *) contents);
+  return true;
+}
+
+/* ============================================================================
+ *  C++ builds instantiate the memory functions (see DCStage.c) over a bus
+ *  policy; a class with static members of the following form:
+ *
+ *    template <typename T> static bool
+ *    read(const struct VR4300PageTable *, uint32_t address, T *contents);
+ *
+ *    template <typename T> static bool
+ *    write(const struct VR4300PageTable *, uint32_t address, const T *);
+ *
+ *  T is an 8, 16, 32 or 64-bit integer in host byte order, or a struct
+ *  UnalignedData for partial stores. Both return false if nothing is
+ *  mapped at the address. A statically linked emulator can bind its RDRAM
+ *  directly, so accesses no longer go through any function pointers:
+ *
+ *    make all-cpp BUS_POLICY_FLAGS='-DVR4300_BUS_POLICY=RDRAMBus \
+ *      -DVR4300_BUS_POLICY_HEADER=\"RDRAMBus.h\"'
+ *
+ *  The default policy, VR4300PageBus, is what C builds use.
+ * ========================================================================= */
+#ifdef __cplusplus
+template <typename T>
+struct VR4300BusType {
+  static const unsigned value =
+    sizeof(T) == 1 ? BUS_TYPE_BYTE :
+    sizeof(T) == 2 ? BUS_TYPE_HWORD :
+    sizeof(T) == 4 ? BUS_TYPE_WORD :
+    sizeof(T) == 8 ? BUS_TYPE_DWORD :
+    BUS_TYPE_UWORD;
+};
+
+struct VR4300PageBus {
+  template <typename T> static inline bool
+  read(const struct VR4300PageTable *pages, uint32_t address, T *contents) {
+    return VR4300PageBusRead(pages,
+      VR4300BusType<T>::value, address, contents);
+  }
+
+  template <typename T> static inline bool
+  write(const struct VR4300PageTable *pages,
+    uint32_t address, const T *contents) {
+    return VR4300PageBusWrite(pages,
+      VR4300BusType<T>::value, address, contents);
+  }
+};
+
+#ifdef VR4300_BUS_POLICY_HEADER
+#include VR4300_BUS_POLICY_HEADER
+#endif
+
+#ifndef VR4300_BUS_POLICY
+#define VR4300_BUS_POLICY VR4300PageBus
+#endif
+#endif
+
+#endif
+
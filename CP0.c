@@ -11,6 +11,7 @@
 #include "Common.h"
 #include "CP0.h"
 #include "CPU.h"
+#include "IdleLoop.h"
 
 #ifdef __cplusplus
 #include <cassert>
@@ -93,6 +94,9 @@ VR4300ERET(struct VR4300 *vr4300) {
     vr4300->cp0.regs.status.exl = 0;
   }
 
+  VR4300UpdateRegionMap(&vr4300->regionMap, vr4300);
+  VR4300FlushMicroTLBs(&vr4300->tlb);
+
   /* Flatten branches in main loop. */
   static const uint8_t mask[2] = {0, 0xFF};
 
@@ -101,6 +105,8 @@ VR4300ERET(struct VR4300 *vr4300) {
     !vr4300->cp0.regs.status.exl &&
     !vr4300->cp0.regs.status.erl];
 
+  VR4300UpdateInterrupts(vr4300);
+  VR4300IdleLoopSideEffect(vr4300);
   vr4300->cp0.regs.llBit = 0;
   icrfLatch->iwMask = 0;
 }
@@ -131,8 +137,8 @@ VR4300MFC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned rd = rfexLatch->iw >> 11 & 0x1F;
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned rd = rfexLatch->operands.rd;
+  unsigned dest = rfexLatch->operands.rt;
   int32_t result;
 
   switch((enum VR4300CP0RegisterID) rd) {
@@ -165,7 +171,8 @@ VR4300MFC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
     break;
 
   case VR4300_CP0_REGISTER_COUNT:
-    result = vr4300->cp0.regs.count;
+    VR4300IdleLoopSideEffect(vr4300);
+    result = VR4300GetCount(vr4300);
     break;
 
   case VR4300_CP0_REGISTER_ENTRYHI:
@@ -232,7 +239,9 @@ VR4300MFC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
 void
 VR4300MTC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
-  unsigned rd = rfexLatch->iw >> 11 & 0x1F;
+  unsigned rd = rfexLatch->operands.rd;
+
+  VR4300IdleLoopSideEffect(vr4300);
 
   switch((enum VR4300CP0RegisterID) rd) {
   case VR4300_CP0_REGISTER_INDEX:
@@ -262,9 +271,14 @@ VR4300MTC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
 
   case VR4300_CP0_REGISTER_COUNT:
     vr4300->cp0.regs.count = rt;
+    vr4300->cp0.countCycle = vr4300->pipeline.cycles;
+    VR4300ScheduleCompare(vr4300);
     break;
 
   case VR4300_CP0_REGISTER_ENTRYHI:
+    if (vr4300->cp0.regs.entryHi.asid != (rt & 0xFF))
+      VR4300FlushMicroTLBs(&vr4300->tlb);
+
     vr4300->cp0.regs.entryHi.asid = rt & 0xFF;
     vr4300->cp0.regs.entryHi.vpn2 = rt >> 13 & 0x7FFFFFF;
     vr4300->cp0.regs.entryHi.region = rt >> 62 & 0x3;
@@ -273,9 +287,16 @@ VR4300MTC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   case VR4300_CP0_REGISTER_COMPARE:
     vr4300->cp0.regs.cause.ip &= ~0x80;
     vr4300->cp0.regs.compare = rt;
+    VR4300ScheduleCompare(vr4300);
+    VR4300UpdateInterrupts(vr4300);
     break;
 
   case VR4300_CP0_REGISTER_STATUS:
+    if (vr4300->cp0.regs.status.exl != (rt >> 1 & 0x1) ||
+      vr4300->cp0.regs.status.erl != (rt >> 2 & 0x1) ||
+      vr4300->cp0.regs.status.ksu != (rt >> 3 & 0x3))
+      VR4300FlushMicroTLBs(&vr4300->tlb);
+
     vr4300->cp0.regs.status.ie = rt & 0x1;
     vr4300->cp0.regs.status.exl = rt >> 1 & 0x1;
     vr4300->cp0.regs.status.erl = rt >> 2 & 0x1;
@@ -295,6 +316,7 @@ VR4300MTC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
     vr4300->cp0.regs.status.rp = rt >> 27 & 0x1;
     vr4300->cp0.regs.status.cu = rt >> 28 & 0xF;
     assert(vr4300->cp0.regs.status.re == 0);
+    VR4300UpdateRegionMap(&vr4300->regionMap, vr4300);
 
     /* Flatten branches in main loop. */
     static const uint8_t mask[2] = {0, 0xFF};
@@ -305,12 +327,14 @@ VR4300MTC0(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
       !vr4300->cp0.regs.status.erl
     ];
 
+    VR4300UpdateInterrupts(vr4300);
     break;
 
   case VR4300_CP0_REGISTER_CAUSE:
     vr4300->cp0.regs.cause.ip &= ~0x03;
     vr4300->cp0.regs.cause.ip |= rt >> 8 & 0x3;
     assert((vr4300->cp0.regs.cause.ip & 0x3) == 0);
+    VR4300UpdateInterrupts(vr4300);
     break;
 
   case VR4300_CP0_REGISTER_EPC:
@@ -354,6 +378,62 @@ VR4300SWC0(struct VR4300 *unused(vr4300),
   debug("Unimplemented function: SWC0.");
 }
 
+/* ============================================================================
+ *  VR4300GetCount: Derives Count from the cycle counter. Count ticks on
+ *  every odd PCycle, so it is only ever materialized when it is read.
+ * ========================================================================= */
+uint32_t
+VR4300GetCount(const struct VR4300 *vr4300) {
+  unsigned long long now = vr4300->pipeline.cycles;
+  unsigned long long then = vr4300->cp0.countCycle;
+
+  return vr4300->cp0.regs.count +
+    (uint32_t) (((now + 1) >> 1) - ((then + 1) >> 1));
+}
+
+/* ============================================================================
+ *  VR4300ScheduleCompare: Computes the PCycle at which Count will next
+ *  equal Compare. Must be called whenever either register is written.
+ * ========================================================================= */
+void
+VR4300ScheduleCompare(struct VR4300 *vr4300) {
+  unsigned long long now = vr4300->pipeline.cycles;
+  uint64_t delta = (uint32_t) (vr4300->cp0.regs.compare -
+    VR4300GetCount(vr4300));
+
+  /* Count doesn't tick on the next PCycle if it's even. */
+  if (delta == 0) {
+    if (now & 0x1) {
+      vr4300->cp0.compareCycle = now + 1;
+      return;
+    }
+
+    delta = 1ULL << 32;
+  }
+
+  vr4300->cp0.compareCycle = (((now + 1) >> 1) + delta) * 2 - 1;
+}
+
+/* ============================================================================
+ *  VR4300RaiseTimerInterrupt: Called once Count has reached Compare.
+ * ========================================================================= */
+void
+VR4300RaiseTimerInterrupt(struct VR4300 *vr4300) {
+  vr4300->cp0.regs.cause.ip |= 0x80;
+  VR4300UpdateInterrupts(vr4300);
+  VR4300ScheduleCompare(vr4300);
+}
+
+/* ============================================================================
+ *  VR4300UpdateInterrupts: Recomputes whether an interrupt is pending.
+ *  Must be called whenever Cause.IP, Status.IM, or the raise mask changes.
+ * ========================================================================= */
+void
+VR4300UpdateInterrupts(struct VR4300 *vr4300) {
+  uint8_t mask = vr4300->cp0.regs.cause.ip & vr4300->cp0.regs.status.im;
+  vr4300->cp0.interruptPending = (mask & vr4300->cp0.interruptRaiseMask) != 0;
+}
+
 /* ============================================================================
  *  VR4300InitCP0: Initializes the co-processor.
  * ========================================================================= */
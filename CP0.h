@@ -197,10 +197,23 @@ struct VR4300CP0Registers {
 
 struct VR4300CP0 {
   struct VR4300CP0Registers regs;
+
+  /* Count is derived from the cycle counter; */
+  /* regs.count holds its value at countCycle. */
+  unsigned long long countCycle;
+  unsigned long long compareCycle;
+
   uint8_t interruptRaiseMask;
+  bool interruptPending;
 };
 
+struct VR4300;
+
 void VR4300InitCP0(struct VR4300CP0 *);
+uint32_t VR4300GetCount(const struct VR4300 *);
+void VR4300ScheduleCompare(struct VR4300 *);
+void VR4300RaiseTimerInterrupt(struct VR4300 *);
+void VR4300UpdateInterrupts(struct VR4300 *);
 
 #endif
 
@@ -109,8 +109,8 @@ VR4300ABSd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -142,8 +142,8 @@ VR4300ABSs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -175,9 +175,9 @@ VR4300ADDd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -211,9 +211,9 @@ VR4300ADDs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -247,8 +247,8 @@ VR4300Ceqd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t NOTun, eq;
 
   FPUClearExceptions();
@@ -283,8 +283,8 @@ VR4300Ceqs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t NOTun, eq;
 
   FPUClearExceptions();
@@ -347,8 +347,8 @@ VR4300Cled(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, le;
 
   FPUClearExceptions();
@@ -389,8 +389,8 @@ VR4300Cles(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, le;
 
   FPUClearExceptions();
@@ -431,8 +431,8 @@ VR4300Cltd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, lt;
 
   FPUClearExceptions();
@@ -473,8 +473,8 @@ VR4300Clts(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, lt;
 
   FPUClearExceptions();
@@ -515,8 +515,8 @@ VR4300Cngld(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, eq;
 
   FPUClearExceptions();
@@ -556,8 +556,8 @@ VR4300Cngls(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, eq;
 
   FPUClearExceptions();
@@ -597,8 +597,8 @@ VR4300Cnged(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, lt;
 
   FPUClearExceptions();
@@ -638,8 +638,8 @@ VR4300Cnges(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, lt;
 
   FPUClearExceptions();
@@ -679,8 +679,8 @@ VR4300Cngled(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
 
   FPUClearExceptions();
 
@@ -715,8 +715,8 @@ VR4300Cngles(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
 
   FPUClearExceptions();
 
@@ -751,8 +751,8 @@ VR4300Cngtd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, le;
 
   FPUClearExceptions();
@@ -792,8 +792,8 @@ VR4300Cngts(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, le;
 
   FPUClearExceptions();
@@ -833,8 +833,8 @@ VR4300Coled(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t NOTun, le;
 
   FPUClearExceptions();
@@ -869,8 +869,8 @@ VR4300Coles(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t NOTun, le;
 
   FPUClearExceptions();
@@ -905,8 +905,8 @@ VR4300Coltd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t NOTun, lt;
 
   FPUClearExceptions();
@@ -941,8 +941,8 @@ VR4300Colts(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t NOTun, lt;
 
   FPUClearExceptions();
@@ -979,8 +979,8 @@ VR4300Cseqd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, eq;
 
   FPUClearExceptions();
@@ -1021,8 +1021,8 @@ VR4300Cseqs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, eq;
 
   FPUClearExceptions();
@@ -1063,8 +1063,8 @@ VR4300Csfd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un;
 
   FPUClearExceptions();
@@ -1101,8 +1101,8 @@ VR4300Csfs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un;
 
   FPUClearExceptions();
@@ -1140,8 +1140,8 @@ VR4300Cueqd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, eq;
 
   FPUClearExceptions();
@@ -1176,8 +1176,8 @@ VR4300Cueqs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, eq;
 
   FPUClearExceptions();
@@ -1212,8 +1212,8 @@ VR4300Cultd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, lt;
 
   FPUClearExceptions();
@@ -1248,8 +1248,8 @@ VR4300Cults(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, lt;
 
   FPUClearExceptions();
@@ -1284,8 +1284,8 @@ VR4300Culed(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, le;
 
   FPUClearExceptions();
@@ -1320,8 +1320,8 @@ VR4300Cules(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
   uint8_t un, le;
 
   FPUClearExceptions();
@@ -1356,8 +1356,8 @@ VR4300Cund(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
 
   FPUClearExceptions();
 
@@ -1387,8 +1387,8 @@ VR4300Cuns(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
 
   FPUClearExceptions();
 
@@ -1418,8 +1418,8 @@ VR4300CEILld(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
   int oldround;
 
@@ -1456,8 +1456,8 @@ VR4300CEILls(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
   int oldround;
 
@@ -1494,8 +1494,8 @@ VR4300CEILwd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
   int oldround;
 
@@ -1532,8 +1532,8 @@ VR4300CEILws(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
   int oldround;
 
@@ -1590,11 +1590,11 @@ VR4300CFC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300CP1Control *control = &vr4300->cp1.control;
-  unsigned rt = GET_RT(rfexLatch->iw); 
+  unsigned rt = rfexLatch->operands.rt; 
   int32_t result;
 
 #ifndef NDEBUG
-  unsigned fs = GET_FS(rfexLatch->iw);
+  unsigned fs = rfexLatch->operands.rd;
   assert ((fs == 31) && "Tried to read reserved CP1 register.");
 #endif
 
@@ -1639,7 +1639,7 @@ VR4300CTC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
 
 #ifndef NDEBUG
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
-  unsigned fs = GET_FS(rfexLatch->iw);
+  unsigned fs = rfexLatch->operands.rd;
 
   assert(fs == 31 && "Tried to modify reserved CP1 register.");
 #endif
@@ -1668,8 +1668,8 @@ VR4300CVTds(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -1700,8 +1700,8 @@ VR4300CVTdl(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -1732,8 +1732,8 @@ VR4300CVTdw(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -1764,8 +1764,8 @@ VR4300CVTld(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
 
   FPUClearExceptions();
@@ -1796,8 +1796,8 @@ VR4300CVTls(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
 
   FPUClearExceptions();
@@ -1828,8 +1828,8 @@ VR4300CVTsd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -1860,8 +1860,8 @@ VR4300CVTsl(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -1892,8 +1892,8 @@ VR4300CVTsw(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -1924,8 +1924,8 @@ VR4300CVTwd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
 
   FPUClearExceptions();
@@ -1956,8 +1956,8 @@ VR4300CVTws(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
 
   FPUClearExceptions();
@@ -1989,8 +1989,8 @@ VR4300DMFC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   uint64_t result;
 
-  unsigned fs = GET_FS(rfexLatch->iw);
-  unsigned rt = GET_RT(rfexLatch->iw);
+  unsigned fs = rfexLatch->operands.rd;
+  unsigned rt = rfexLatch->operands.rt;
 
   if (!FPUCheckUsable(vr4300))
     return;
@@ -2012,9 +2012,9 @@ VR4300DIVd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -2048,9 +2048,9 @@ VR4300DIVs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -2082,7 +2082,7 @@ VR4300DIVs(struct VR4300 *vr4300) {
 void
 VR4300DMTC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
-  unsigned fs = GET_FS(rfexLatch->iw);
+  unsigned fs = rfexLatch->operands.rd;
 
   if (!FPUCheckUsable(vr4300))
     return;
@@ -2101,8 +2101,8 @@ VR4300FLOORld(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
   int oldround;
 
@@ -2139,8 +2139,8 @@ VR4300FLOORls(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
   int oldround;
 
@@ -2177,8 +2177,8 @@ VR4300FLOORwd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
   int oldround;
 
@@ -2215,8 +2215,8 @@ VR4300FLOORws(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
   int oldround;
 
@@ -2253,7 +2253,7 @@ VR4300LDC1(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned ft = GET_FT(rfexLatch->iw);
+  unsigned ft = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -2277,7 +2277,7 @@ VR4300LWC1(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned rt = GET_RT(rfexLatch->iw);
+  unsigned rt = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -2302,8 +2302,8 @@ VR4300MOVd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   value = fs->d.data;
@@ -2318,8 +2318,8 @@ VR4300MOVs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   value = fs->s.data[0];
@@ -2335,8 +2335,8 @@ VR4300MFC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   int32_t result;
 
-  unsigned fs = GET_FS(rfexLatch->iw);
-  unsigned rt = GET_RT(rfexLatch->iw);
+  unsigned fs = rfexLatch->operands.rd;
+  unsigned rt = rfexLatch->operands.rt;
 
   if (!FPUCheckUsable(vr4300))
     return;
@@ -2356,7 +2356,7 @@ VR4300MFC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
 void
 VR4300MTC1(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
-  unsigned fs = GET_FS(rfexLatch->iw);
+  unsigned fs = rfexLatch->operands.rd;
 
   if (!FPUCheckUsable(vr4300))
     return;
@@ -2375,9 +2375,9 @@ VR4300MULd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -2411,9 +2411,9 @@ VR4300MULs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -2447,8 +2447,8 @@ VR4300NEGd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -2480,8 +2480,8 @@ VR4300NEGs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -2513,8 +2513,8 @@ VR4300ROUNDld(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
 
   FPUClearExceptions();
@@ -2545,8 +2545,8 @@ VR4300ROUNDls(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
 
   FPUClearExceptions();
@@ -2577,8 +2577,8 @@ VR4300ROUNDwd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
 
   FPUClearExceptions();
@@ -2609,8 +2609,8 @@ VR4300ROUNDws(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
 
   FPUClearExceptions();
@@ -2641,7 +2641,7 @@ VR4300SDC1(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned ft = GET_FT(rfexLatch->iw);
+  unsigned ft = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -2665,8 +2665,8 @@ VR4300SQRTd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -2698,8 +2698,8 @@ VR4300SQRTs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -2731,9 +2731,9 @@ VR4300SUBd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   double value;
 
   FPUClearExceptions();
@@ -2767,9 +2767,9 @@ VR4300SUBs(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  const union VR4300CP1Register *ft = &cp1->regs[GET_FT(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  const union VR4300CP1Register *ft = &cp1->regs[rfexLatch->operands.rt];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   float value;
 
   FPUClearExceptions();
@@ -2803,7 +2803,7 @@ VR4300SWC1(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned ft = GET_FT(rfexLatch->iw);
+  unsigned ft = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -2827,8 +2827,8 @@ VR4300TRUNCld(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
 
   FPUClearExceptions();
@@ -2859,8 +2859,8 @@ VR4300TRUNCls(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint64_t value;
 
   FPUClearExceptions();
@@ -2891,8 +2891,8 @@ VR4300TRUNCwd(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
 
   FPUClearExceptions();
@@ -2923,8 +2923,8 @@ VR4300TRUNCws(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300CP1 *cp1 = &vr4300->cp1;
 
-  const union VR4300CP1Register *fs = &cp1->regs[GET_FS(rfexLatch->iw)];
-  union VR4300CP1Register *fd = &cp1->regs[GET_FD(rfexLatch->iw)];
+  const union VR4300CP1Register *fs = &cp1->regs[rfexLatch->operands.rd];
+  union VR4300CP1Register *fd = &cp1->regs[rfexLatch->operands.sa];
   uint32_t value;
 
   FPUClearExceptions();
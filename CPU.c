@@ -40,7 +40,7 @@
 #define MI_INTR_DP 0x20
 
 static void CheckForRCPInterrupts(struct VR4300 *);
-static void InitVR4300(struct VR4300 *);
+static bool InitVR4300(struct VR4300 *);
 
 /* ============================================================================
  *  Mnemonics table.
@@ -69,6 +69,8 @@ CheckForRCPInterrupts(struct VR4300 *vr4300) {
     vr4300->cp0.regs.cause.ip |= 0x04;
   else
     vr4300->cp0.regs.cause.ip &= ~0x04;
+
+  VR4300UpdateInterrupts(vr4300);
 }
 
 /* ============================================================================
@@ -77,21 +79,36 @@ CheckForRCPInterrupts(struct VR4300 *vr4300) {
 void
 ConnectVR4300ToBus(struct VR4300 *vr4300, struct BusController *bus) {
   vr4300->bus = bus;
+  vr4300->pageTable.bus = bus;
 }
 
 /* ============================================================================
- *  CreateVR4300: Creates and initializes a VR4300 instance.
+ *  CreateVR4300: Creates and initializes a VR4300 instance. Flags select
+ *  optional modes (see enum VR4300CreateFlags); unavailable ones are off.
  * ========================================================================= */
 struct VR4300 *
-CreateVR4300(void) {
+CreateVR4300(unsigned flags) {
   struct VR4300 *vr4300;
 
   if ((vr4300 = (struct VR4300*) malloc(sizeof(struct VR4300))) == NULL) {
     debug("Failed to allocate memory.");
     return NULL;
   }
-  
-  InitVR4300(vr4300);
+
+  if (!InitVR4300(vr4300)) {
+    free(vr4300);
+    return NULL;
+  }
+
+  if ((flags & VR4300_CREATE_FASTMEM) && !VR4300EnableFastmem(vr4300)) {
+    debug("Fastmem is unavailable; using the page table.");
+  }
+
+  if ((flags & VR4300_CREATE_PREDECODE) &&
+    !VR4300EnablePredecodeCache(&vr4300->predecode)) {
+    debug("Predecode cache is unavailable; decoding every fetch.");
+  }
+
   return vr4300;
 }
 
@@ -101,13 +118,20 @@ CreateVR4300(void) {
  *========================================================================== */
 void
 DestroyVR4300(struct VR4300 *vr4300) {
+  VR4300DestroyBlockCache(&vr4300->blockCache);
+  VR4300DestroyFastmem(vr4300);
+  VR4300DestroyPageTable(&vr4300->pageTable);
+  VR4300DestroyPredecodeCache(&vr4300->predecode);
+  VR4300DestroyRecompiler(&vr4300->recompiler);
+  VR4300UnloadStaticCode(vr4300);
   free(vr4300);
 }
 
 /* ============================================================================
- *  InitVR4300: Initializes the VR4300.
+ *  InitVR4300: Initializes the VR4300. Returns false if the page table
+ *  couldn't be allocated; nothing else has been allocated at that point.
  * ========================================================================= */
-static void
+static bool
 InitVR4300(struct VR4300 *vr4300) {
   debug("Initializing CPU.");
 	memset(vr4300, 0, sizeof(*vr4300));
@@ -116,13 +140,29 @@ InitVR4300(struct VR4300 *vr4300) {
   VR4300InitCP0(&vr4300->cp0);
   VR4300InitCP1(&vr4300->cp1);
   VR4300InitDCache(&vr4300->dcache);
+  VR4300InitFastmem(&vr4300->fastmem);
   VR4300InitICache(&vr4300->icache);
+
+  if (!VR4300InitPageTable(&vr4300->pageTable))
+    return false;
+
+  VR4300InitPredecodeCache(&vr4300->predecode);
+  VR4300InitWriteBuffer(&vr4300->writeBuffer);
+  vr4300->pageTable.writeBuffer = &vr4300->writeBuffer;
+  VR4300InitBlockCache(&vr4300->blockCache);
+  vr4300->blockCache.codePages = &vr4300->codePages;
+  vr4300->predecode.codePages = &vr4300->codePages;
+  VR4300InitRecompiler(&vr4300->recompiler);
+  VR4300InitStaticCode(&vr4300->staticCode);
   VR4300InitTLB(&vr4300->tlb);
+  VR4300UpdateRegionMap(&vr4300->regionMap, vr4300);
   VR4300InitPipeline(&vr4300->pipeline);
+  VR4300ScheduleCompare(vr4300);
 
   /* MESS uses this version, so we will too? */
   vr4300->miregs[MI_VERSION_REG] = 0x01010101;
   vr4300->miregs[MI_INIT_MODE_REG] = 0x80;
+  return true;
 }
 
 /* ============================================================================
@@ -227,8 +267,37 @@ void
 VR4300ClearRCPInterrupt(struct VR4300 *vr4300, unsigned mask) {
   vr4300->miregs[MI_INTR_REG] &= ~mask;
 
-  if (!(vr4300->miregs[MI_INTR_REG] & vr4300->miregs[MI_INTR_MASK_REG]))
+  if (!(vr4300->miregs[MI_INTR_REG] & vr4300->miregs[MI_INTR_MASK_REG])) {
     vr4300->cp0.regs.cause.ip &= ~0x04;
+    VR4300UpdateInterrupts(vr4300);
+  }
+}
+
+/* ============================================================================
+ *  VR4300InvalidateCode: Discards any blocks or predecoded instructions that
+ *  were decoded from a range of physical memory. The caches are left alone.
+ * ========================================================================= */
+void
+VR4300InvalidateCode(struct VR4300 *vr4300,
+  uint32_t paddr, uint32_t length) {
+  VR4300InvalidateBlocks(&vr4300->blockCache, paddr, length);
+  VR4300InvalidatePredecode(&vr4300->predecode, paddr, length);
+}
+
+/* ============================================================================
+ *  VR4300InvalidateRange: Discards anything cached or decoded from a range
+ *  of physical memory that was written behind the CPU's back (i.e., DMA).
+ *  Only the lines and pages within the range are looked at.
+ * ========================================================================= */
+void
+VR4300InvalidateRange(struct VR4300 *vr4300,
+  uint32_t paddr, uint32_t length) {
+  if (length == 0)
+    return;
+
+  VR4300ICacheInvalidateRange(&vr4300->icache, paddr, length);
+  VR4300DCacheInvalidateRange(&vr4300->dcache, paddr, length);
+  VR4300InvalidateCode(vr4300, paddr, length);
 }
 
 /* ============================================================================
@@ -238,7 +307,11 @@ void
 VR4300RaiseRCPInterrupt(struct VR4300 *vr4300, unsigned mask) {
   vr4300->miregs[MI_INTR_REG] |= mask;
 
-  if (vr4300->miregs[MI_INTR_REG] & vr4300->miregs[MI_INTR_MASK_REG])
+  /* Give the embedder a chance to resync. */
+  if (vr4300->miregs[MI_INTR_REG] & vr4300->miregs[MI_INTR_MASK_REG]) {
     vr4300->cp0.regs.cause.ip |= 0x04;
+    VR4300UpdateInterrupts(vr4300);
+    VR4300StopRun(vr4300);
+  }
 }
 
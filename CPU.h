@@ -11,13 +11,22 @@
 #ifndef __VR4300__CPU_H__
 #define __VR4300__CPU_H__
 #include "Common.h"
+#include "BlockCache.h"
 #include "CP0.h"
 #include "CP1.h"
+#include "CodePages.h"
 #include "DCache.h"
 #include "Externs.h"
+#include "Fastmem.h"
 #include "ICache.h"
+#include "PageTable.h"
 #include "Pipeline.h"
+#include "Predecode.h"
+#include "Recompiler.h"
+#include "Region.h"
+#include "StaticRecompiler.h"
 #include "TLB.h"
+#include "WriteBuffer.h"
 
 #define VR4300_LINK_REGISTER VR4300_REGISTER_RA
 
@@ -56,18 +65,89 @@ struct VR4300 {
   uint32_t miregs[NUM_MI_REGISTERS];
 
   struct VR4300TLB tlb;
+  struct VR4300RegionMap regionMap;
   struct VR4300ICache icache;
   struct VR4300DCache dcache;
+  struct VR4300BlockCache blockCache;
+  struct VR4300PredecodeCache predecode;
+  struct VR4300CodePages codePages;
+  struct VR4300Recompiler recompiler;
+  struct VR4300StaticCode staticCode;
 
   struct BusController *bus;
+  struct VR4300PageTable pageTable;
+  struct VR4300Fastmem fastmem;
+  struct VR4300WriteBuffer writeBuffer;
   struct VR4300CP0 cp0;
   struct VR4300CP1 cp1;
 
   struct VR4300Pipeline pipeline;
 };
 
-struct VR4300 *CreateVR4300(void);
+/* Options for CreateVR4300. */
+enum VR4300CreateFlags {
+  VR4300_CREATE_FASTMEM = 1 << 0,
+  VR4300_CREATE_PREDECODE = 1 << 1,
+};
+
+struct VR4300 *CreateVR4300(unsigned);
 void DestroyVR4300(struct VR4300 *);
 
+void VR4300InvalidateCode(struct VR4300 *, uint32_t, uint32_t);
+
+/* For DMA and other writes to memory that bypass the CPU. */
+void VR4300InvalidateRange(struct VR4300 *, uint32_t, uint32_t);
+
+/* ============================================================================
+ *  VR4300CheckCodeStore: Invalidates any code decoded from the memory that
+ *  a store overwrote. Stores to pages without any only cost a bit test.
+ * ========================================================================= */
+static inline void
+VR4300CheckCodeStore(struct VR4300 *vr4300, uint32_t paddr) {
+  if (unlikely(VR4300IsCodePage(&vr4300->codePages, paddr)))
+    VR4300InvalidateCode(vr4300, paddr & ~0x7U, 8);
+}
+
+/* ============================================================================
+ *  VR4300LookupRegion: Same as GetRegionInfo, but 32-bit addresses (i.e.,
+ *  nearly all of them) only cost a table lookup.
+ * ========================================================================= */
+static inline const struct RegionInfo *
+VR4300LookupRegion(const struct VR4300 *vr4300, uint64_t address) {
+  if (likely((uint64_t) (int64_t) (int32_t) address == address))
+    return vr4300->regionMap.segments[(uint32_t) address >> 29];
+
+  return GetRegionInfo(vr4300, address);
+}
+
+/* ============================================================================
+ *  VR4300LookupRegion32: Same as VR4300LookupRegion, for 32-bit modes; only
+ *  the low 32 bits of the address are looked at.
+ * ========================================================================= */
+static inline const struct RegionInfo *
+VR4300LookupRegion32(const struct VR4300 *vr4300, uint64_t address) {
+  return vr4300->regionMap.segments[(uint32_t) address >> 29];
+}
+
+/* ============================================================================
+ *  VR4300TranslateCode: Translates a mapped instruction fetch address,
+ *  searching the TLB only if the instruction micro-TLB misses.
+ * ========================================================================= */
+static inline bool
+VR4300TranslateCode(struct VR4300 *vr4300, uint64_t vaddr, uint32_t *paddr) {
+  return VR4300MicroTLBLookup(&vr4300->tlb.itlb, vaddr, paddr) ||
+    VR4300TranslateMiss(vr4300, &vr4300->tlb.itlb, vaddr, paddr);
+}
+
+/* ============================================================================
+ *  VR4300TranslateData: Translates a mapped data address, searching the
+ *  TLB only if the data micro-TLB misses.
+ * ========================================================================= */
+static inline bool
+VR4300TranslateData(struct VR4300 *vr4300, uint64_t vaddr, uint32_t *paddr) {
+  return VR4300MicroTLBLookup(&vr4300->tlb.dtlb, vaddr, paddr) ||
+    VR4300TranslateMiss(vr4300, &vr4300->tlb.dtlb, vaddr, paddr);
+}
+
 #endif
 
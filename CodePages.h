@@ -0,0 +1,53 @@
+/* ============================================================================
+ *  CodePages.h: Physical pages that code has been decoded from.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__CODEPAGES_H__
+#define __VR4300__CODEPAGES_H__
+#include "Common.h"
+
+/* Code pages are only tracked within the 512MiB physical address space. */
+#define VR4300_CODE_LIMIT 0x20000000U
+#define VR4300_CODE_PAGES (VR4300_CODE_LIMIT >> 12)
+
+/* One bit for each 4KiB page that the block cache or predecode cache */
+/* decoded something from. Bits stay set once the code is gone; that */
+/* only costs a fruitless search the next time the page is stored to. */
+struct VR4300CodePages {
+  uint8_t bits[VR4300_CODE_PAGES >> 3];
+};
+
+/* ============================================================================
+ *  VR4300IsCodePage: Returns true if code was decoded from the page.
+ * ========================================================================= */
+static inline bool
+VR4300IsCodePage(const struct VR4300CodePages *pages, uint32_t paddr) {
+  uint32_t page = paddr >> 12;
+
+  return paddr < VR4300_CODE_LIMIT &&
+    (pages->bits[page >> 3] & (1 << (page & 0x7))) != 0;
+}
+
+/* ============================================================================
+ *  VR4300MarkCodePage: Notes that code was decoded from the page. Returns
+ *  false if the page isn't tracked, in which case stores won't be checked.
+ * ========================================================================= */
+static inline bool
+VR4300MarkCodePage(struct VR4300CodePages *pages, uint32_t paddr) {
+  uint32_t page = paddr >> 12;
+
+  if (paddr >= VR4300_CODE_LIMIT)
+    return false;
+
+  pages->bits[page >> 3] |= 1 << (page & 0x7);
+  return true;
+}
+
+#endif
+
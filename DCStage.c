@@ -9,11 +9,14 @@
  *  file 'LICENSE', which is part of this source code package.
  * ========================================================================= */
 #include "Common.h"
+#include "BusPolicy.h"
 #include "CPU.h"
 #include "DCache.h"
 #include "DCStage.h"
 #include "Fault.h"
+#include "IdleLoop.h"
 #include "Pipeline.h"
+#include "Predecode.h"
 #include "Region.h"
 #include "TLB.h"
 
@@ -27,10 +30,105 @@
 #include <string.h>
 #endif
 
+/* ============================================================================
+ *  The memory functions are written once against a bus policy. C++ builds
+ *  instantiate them over VR4300_BUS_POLICY (see BusPolicy.h), and C builds
+ *  always go through the page table. Either way, the exported VR4300Load*
+ *  and VR4300Store* functions are what EX hands to us.
+ * ========================================================================= */
+#ifdef __cplusplus
+#define BUS_TEMPLATE template <class Bus> static
+#define BusPolicyRead(type, pages, address, contents) \
+  Bus::read(pages, address, contents)
+#define BusPolicyWrite(type, pages, address, contents) \
+  Bus::write(pages, address, contents)
+
+#else
+#define BUS_TEMPLATE static
+#define BusPolicyRead(type, pages, address, contents) \
+  VR4300PageBusRead(pages, type, address, contents)
+#define BusPolicyWrite(type, pages, address, contents) \
+  VR4300PageBusWrite(pages, type, address, contents)
+#endif
+
+static const struct RegionInfo *FindRegion(struct VR4300 *, uint64_t);
+
+BUS_TEMPLATE void LoadByte(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadByteU(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadDWord(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadDWordLeft(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadDWordRight(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadHWord(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadHWordU(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadWord(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadWordFPU(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadWordLeft(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadWordRight(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void LoadWordU(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreByte(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreDWord(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreDWordLeft(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreDWordRight(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreHWord(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreWord(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreWordLeft(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+BUS_TEMPLATE void StoreWordRight(const struct VR4300MemoryData *,
+  const struct VR4300PageTable *, struct VR4300DCacheLine *);
+
+/* ============================================================================
+ *  FindRegion: Looks for the region of an address that isn't in the most
+ *  recently used one. Whatever is found is moved to the front.
+ * ========================================================================= */
+static const struct RegionInfo *
+FindRegion(struct VR4300 *vr4300, uint64_t address) {
+  struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
+  const struct RegionInfo *region;
+  unsigned i;
+
+  for (i = 1; i < VR4300_DC_REGIONS; i++) {
+    region = dcwbLatch->regions[i];
+
+    if ((address - region->start) < region->length)
+      break;
+  }
+
+  if (i == VR4300_DC_REGIONS) {
+    if ((region = VR4300LookupRegion(vr4300, address)) == NULL)
+      return NULL;
+
+    i--;
+  }
+
+  for (; i > 0; i--)
+    dcwbLatch->regions[i] = dcwbLatch->regions[i - 1];
+
+  dcwbLatch->regions[0] = region;
+  return region;
+}
+
 /* ============================================================================
  *  VR4300DCStage: Reads or writes data from or to DCache/Bus.
  * ========================================================================= */
-void
+VR4300_MODE_TEMPLATE void
 VR4300DCStage(struct VR4300 *vr4300) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
@@ -52,28 +150,34 @@ VR4300DCStage(struct VR4300 *vr4300) {
   }
 
   /* Lookup the region that our address lies in. */
+  /* 32-bit modes only need the table; others check recent ones first. */
   memoryData->function = NULL;
-  region = dcwbLatch->region;
 
-  if ((memoryData->address - region->start) >= region->length) {
-    if ((region = GetRegionInfo(vr4300, memoryData->address)) == NULL) {
-      memset(&dcwbLatch->result, 0, sizeof(dcwbLatch->result));
-      debug("Unimplemented fault: VR4300_FAULT_DADE.");
-      return;
-    }
+  if (VR4300_THIS_MODE != VR4300_MODE_64BIT)
+    region = VR4300LookupRegion32(vr4300, memoryData->address);
+
+  else if ((memoryData->address - dcwbLatch->regions[0]->start) >=
+    dcwbLatch->regions[0]->length)
+    region = FindRegion(vr4300, memoryData->address);
 
-    dcwbLatch->region = region;
+  else
+    region = dcwbLatch->regions[0];
+
+  if (unlikely(region == NULL)) {
+    memset(&dcwbLatch->result, 0, sizeof(dcwbLatch->result));
+    debug("Unimplemented fault: VR4300_FAULT_DADE.");
+    return;
   }
 
   vaddr = memoryData->address;
   memoryData->address -= region->offset;
 
-  if (region->mapped) {
+  if (VR4300RegionMapped(VR4300_THIS_MODE, region)) {
     uint32_t paddr;
 
     debugarg("TLB Data Access: Address: 0x%.16lX.", memoryData->address);
 
-    if (!VR4300Translate(vr4300, memoryData->address, &paddr)) {
+    if (!VR4300TranslateData(vr4300, memoryData->address, &paddr)) {
       debugarg("TLB Miss: Address: 0x%.16lX.", memoryData->address);
       debug("Unimplemented fault: VR4300_TLB_...");
     }
@@ -84,41 +188,66 @@ VR4300DCStage(struct VR4300 *vr4300) {
     }
   }
 
-  if (region->cached) {
+  if (VR4300RegionCached(VR4300_THIS_MODE, region)) {
     if ((line = VR4300DCacheProbe(
       dcache, vaddr, memoryData->address)) == NULL) {
-      VR4300DCacheFill(dcache, vr4300->bus, vaddr, memoryData->address);
+      VR4300DCacheFill(dcache, &vr4300->pageTable,
+        vaddr, memoryData->address);
       line = VR4300DCacheProbe(dcache, vaddr, memoryData->address);
     }
   }
 
-  /* TODO: Bypass the write buffers. */
-  function(memoryData, vr4300->bus, line);
+  function(memoryData, &vr4300->pageTable, line);
+
+  /* Only loads set a target; loads from RDRAM have no side effects. */
+  if (memoryData->target == NULL) {
+    if (line != NULL)
+      VR4300DCacheMarkDirty(dcache, line);
+
+    VR4300CheckCodeStore(vr4300, memoryData->address);
+    VR4300IdleLoopSideEffect(vr4300);
+  }
+
+  else if (memoryData->address >= VR4300_RDRAM_END)
+    VR4300IdleLoopSideEffect(vr4300);
+
+  memoryData->target = NULL;
 }
 
 /* ============================================================================
- *  VR4300LoadByte: Reads a byte from the DCache/Bus.
+ *  Exported stage; the instantiations for each addressing mode.
  * ========================================================================= */
+#ifdef __cplusplus
+template void VR4300DCStage<VR4300_MODE_KERNEL32>(struct VR4300 *);
+template void VR4300DCStage<VR4300_MODE_USER32>(struct VR4300 *);
+template void VR4300DCStage<VR4300_MODE_64BIT>(struct VR4300 *);
+
 void
-VR4300LoadByte(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+VR4300DCStage(struct VR4300 *vr4300) {
+  VR4300DCStage<VR4300_MODE_64BIT>(vr4300);
+}
+#endif
+
+/* ============================================================================
+ *  LoadByte: Reads a byte from the DCache/Bus.
+ * ========================================================================= */
+BUS_TEMPLATE void
+LoadByte(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   int64_t result;
   int8_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xF), sizeof(contents));
+    memcpy(&contents, line->data + ((address & 0xF) ^
+      VR4300_DCACHE_BYTE_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_BYTE, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_BYTE, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -126,28 +255,25 @@ VR4300LoadByte(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadByteU: Reads a byte from the DCache/Bus.
+ *  LoadByteU: Reads a byte from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadByteU(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadByteU(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   uint64_t result;
   uint8_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xF), sizeof(contents));
+    memcpy(&contents, line->data + ((address & 0xF) ^
+      VR4300_DCACHE_BYTE_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_BYTE, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_BYTE, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -155,28 +281,24 @@ VR4300LoadByteU(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadDWord: Reads a doubleword from the DCache/Bus.
+ *  LoadDWord: Reads a doubleword from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadDWord(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadDWord(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   uint64_t result;
   uint64_t contents;
-  void *opaque;
 
   if (line != NULL) {
     memcpy(&contents, line->data + (address & 0x8), sizeof(contents));
-    result = ByteOrderSwap64(contents);
+    result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_DWORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_DWORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -184,7 +306,7 @@ VR4300LoadDWord(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadDWordLeft: Reads a doubleword from the DCache/Bus.
+ *  LoadDWordLeft: Reads a doubleword from the DCache/Bus.
  * ========================================================================= */
 static const uint64_t LoadDWordLeftMaskTable[8] = {
   0x0000000000000000ULL,
@@ -197,28 +319,23 @@ static const uint64_t LoadDWordLeftMaskTable[8] = {
   0x00FFFFFFFFFFFFFFULL,
 };
 
-void
-VR4300LoadDWordLeft(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadDWordLeft(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address & 0xFFFFFFF8;
   unsigned type = memoryData->address & 0x7;
   uint64_t mask = LoadDWordLeftMaskTable[type];
-  MemoryFunction read;
 
   uint64_t result, olddata;
   uint64_t contents;
-  void *opaque;
 
   if (line != NULL) {
     memcpy(&contents, line->data + (address & 0x8), sizeof(contents));
-    contents = ByteOrderSwap64(contents);
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_DWORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_DWORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
   }
 
   memcpy(&olddata, memoryData->target, sizeof(olddata));
@@ -227,7 +344,7 @@ VR4300LoadDWordLeft(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadDWordRight: Reads a doubleword from the DCache/Bus.
+ *  LoadDWordRight: Reads a doubleword from the DCache/Bus.
  * ========================================================================= */
 static const uint64_t LoadDWordRightMaskTable[8] = {
   0xFFFFFFFFFFFFFF00ULL,
@@ -240,28 +357,23 @@ static const uint64_t LoadDWordRightMaskTable[8] = {
   0x0000000000000000ULL,
 };
 
-void
-VR4300LoadDWordRight(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadDWordRight(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address & 0xFFFFFFF8;
   unsigned type = memoryData->address & 0x7;
   uint64_t mask = LoadDWordRightMaskTable[type];
-  MemoryFunction read;
 
   uint64_t result, olddata;
   uint64_t contents;
-  void *opaque;
 
   if (line != NULL) {
     memcpy(&contents, line->data + (address & 0x8), sizeof(contents));
-    contents = ByteOrderSwap64(contents);
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_DWORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_DWORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
   }
 
   memcpy(&olddata, memoryData->target, sizeof(olddata));
@@ -270,29 +382,25 @@ VR4300LoadDWordRight(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadHWord: Reads a halfword from the DCache/Bus.
+ *  LoadHWord: Reads a halfword from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadHWord(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadHWord(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   int64_t result;
   int16_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xE), sizeof(contents));
-    contents = ByteOrderSwap16(contents);
+    memcpy(&contents, line->data + ((address & 0xE) ^
+      VR4300_DCACHE_HWORD_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_HWORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_HWORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -300,29 +408,25 @@ VR4300LoadHWord(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadHWordU: Reads a halfword from the DCache/Bus.
+ *  LoadHWordU: Reads a halfword from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadHWordU(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadHWordU(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   uint64_t result;
   uint16_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xE), sizeof(contents));
-    contents = ByteOrderSwap16(contents);
+    memcpy(&contents, line->data + ((address & 0xE) ^
+      VR4300_DCACHE_HWORD_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_HWORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_HWORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -331,29 +435,25 @@ VR4300LoadHWordU(const struct VR4300MemoryData *memoryData,
 
 
 /* ============================================================================
- *  VR4300LoadWord: Reads a word from the DCache/Bus.
+ *  LoadWord: Reads a word from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadWord(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadWord(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   int64_t result;
   int32_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xC), sizeof(contents));
-    contents = ByteOrderSwap32(contents);
+    memcpy(&contents, line->data + ((address & 0xC) ^
+      VR4300_DCACHE_WORD_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_WORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_WORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -361,29 +461,25 @@ VR4300LoadWord(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadWordFPU: Reads a word from the DCache/Bus.
+ *  LoadWordFPU: Reads a word from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadWordFPU(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadWordFPU(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   uint32_t result;
   uint32_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xC), sizeof(contents));
-    contents = ByteOrderSwap32(contents);
+    memcpy(&contents, line->data + ((address & 0xC) ^
+      VR4300_DCACHE_WORD_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_WORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_WORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -391,29 +487,25 @@ VR4300LoadWordFPU(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadWordU: Reads a word from the DCache/Bus.
+ *  LoadWordU: Reads a word from the DCache/Bus.
  * ========================================================================= */
-void
-VR4300LoadWordU(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadWordU(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
-  MemoryFunction read;
 
   uint64_t result;
   uint32_t contents;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xC), sizeof(contents));
-    contents = ByteOrderSwap32(contents);
+    memcpy(&contents, line->data + ((address & 0xC) ^
+      VR4300_DCACHE_WORD_XOR), sizeof(contents));
     result = contents;
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_WORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_WORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
     result = contents;
   }
 
@@ -421,7 +513,7 @@ VR4300LoadWordU(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadWordLeft: Reads a word from the DCache/Bus.
+ *  LoadWordLeft: Reads a word from the DCache/Bus.
  * ========================================================================= */
 static const uint32_t LoadWordLeftMaskTable[4] = {
   0x00000000,
@@ -430,28 +522,24 @@ static const uint32_t LoadWordLeftMaskTable[4] = {
   0x00FFFFFF
 };
 
-void
-VR4300LoadWordLeft(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadWordLeft(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address & 0xFFFFFFFC;
   unsigned type = memoryData->address & 0x3;
   uint32_t mask = LoadWordLeftMaskTable[type];
-  MemoryFunction read;
 
   int64_t result, regolddata;
   int32_t contents, olddata;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xC), sizeof(contents));
-    contents = ByteOrderSwap32(contents);
+    memcpy(&contents, line->data + ((address & 0xC) ^
+      VR4300_DCACHE_WORD_XOR), sizeof(contents));
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_WORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_WORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
   }
 
   memcpy(&regolddata, memoryData->target, sizeof(regolddata));
@@ -464,7 +552,7 @@ VR4300LoadWordLeft(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300LoadWordRight: Reads a word from the DCache/Bus.
+ *  LoadWordRight: Reads a word from the DCache/Bus.
  * ========================================================================= */
 static const uint32_t LoadWordRightMaskTable[4] = {
   0xFFFFFF00,
@@ -473,28 +561,24 @@ static const uint32_t LoadWordRightMaskTable[4] = {
   0x00000000
 };
 
-void
-VR4300LoadWordRight(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+LoadWordRight(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address & 0xFFFFFFFC;
   unsigned type = memoryData->address & 0x3;
   uint64_t mask = LoadWordRightMaskTable[type];
-  MemoryFunction read;
 
   uint64_t result, regolddata;
   uint32_t contents, olddata;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(&contents, line->data + (address & 0xC), sizeof(contents));
-    contents = ByteOrderSwap32(contents);
+    memcpy(&contents, line->data + ((address & 0xC) ^
+      VR4300_DCACHE_WORD_XOR), sizeof(contents));
   }
 
   else {
-    if ((read = BusRead(bus, BUS_TYPE_WORD, address, &opaque)) == NULL)
+    if (!BusPolicyRead(BUS_TYPE_WORD, pages, address, &contents))
       return;
-
-    read(opaque, address, &contents);
   }
 
   memcpy(&regolddata, memoryData->target, sizeof(regolddata));
@@ -516,227 +600,258 @@ VR4300LoadWordRight(const struct VR4300MemoryData *memoryData,
 }
 
 /* ============================================================================
- *  VR4300StoreByte: Writes a byte to the DCache/Bus.
+ *  StoreByte: Writes a byte to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreByte(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+StoreByte(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
   uint8_t contents = memoryData->data;
-  MemoryFunction write;
-  void *opaque;
 
   if (line != NULL) {
-    memcpy(line->data + (address & 0xF), &contents, sizeof(contents));
-    line->dirty = true;
+    memcpy(line->data + ((address & 0xF) ^
+      VR4300_DCACHE_BYTE_XOR), &contents, sizeof(contents));
   }
 
-  else {
-    if ((write = BusWrite(bus, BUS_TYPE_BYTE, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &contents);
-  }
+  else
+    BusPolicyWrite(BUS_TYPE_BYTE, pages, address, &contents);
 }
 
 /* ============================================================================
- *  VR4300StoreDWord: Writes a doubleword to the DCache/Bus.
+ *  StoreDWord: Writes a doubleword to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreDWord(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+StoreDWord(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
   uint64_t contents = memoryData->data;
-  MemoryFunction write;
-  void *opaque;
 
-  if (line != NULL) {
-    contents = ByteOrderSwap64(contents);
+  if (line != NULL)
     memcpy(line->data + (address & 0x8), &contents, sizeof(contents));
-    line->dirty = true;
-  }
-
-  else {
-    if ((write = BusWrite(bus, BUS_TYPE_DWORD, address, &opaque)) == NULL)
-      return;
 
-    write(opaque, address, &contents);
-  }
+  else
+    BusPolicyWrite(BUS_TYPE_DWORD, pages, address, &contents);
 }
 
 /* ============================================================================
- *  VR4300StoreDWordLeft: Writes a doubleword to the DCache/Bus.
+ *  StoreDWordLeft: Writes a doubleword to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreDWordLeft(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+static const uint64_t StoreDWordLeftMaskTable[8] = {
+  0x0000000000000000ULL,
+  0xFF00000000000000ULL,
+  0xFFFF000000000000ULL,
+  0xFFFFFF0000000000ULL,
+  0xFFFFFFFF00000000ULL,
+  0xFFFFFFFFFF000000ULL,
+  0xFFFFFFFFFFFF0000ULL,
+  0xFFFFFFFFFFFFFF00ULL,
+};
+
+BUS_TEMPLATE void
+StoreDWordLeft(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
+  unsigned type = memoryData->address & 0x7;
   uint64_t contents = memoryData->data;
   struct UnalignedData data;
-  MemoryFunction write;
-  void *opaque;
-
-  /* Pack the unaligned data structure. */
-  /* TODO/FIXME: Take endianness into account. */
-  contents = ByteOrderSwap64(contents);
-  data.size = 8 - (memoryData->address & 0x7);
-  memcpy(data.data, &contents, sizeof(contents));
 
   if (line != NULL) {
-    memcpy(line->data + (address & 0xF), data.data, data.size);
-    line->dirty = true;
+    uint8_t *dword = line->data + (address & 0x8);
+    uint64_t olddata;
+
+    memcpy(&olddata, dword, sizeof(olddata));
+    contents = (contents >> (type << 3)) |
+      (olddata & StoreDWordLeftMaskTable[type]);
+    memcpy(dword, &contents, sizeof(contents));
   }
 
+  /* Pack the unaligned data structure. */
+  /* TODO/FIXME: Take endianness into account. */
   else {
-    if ((write = BusWrite(bus, BUS_TYPE_UDWORD, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &data);
+    contents = ByteOrderSwap64(contents);
+    data.size = 8 - type;
+    memcpy(data.data, &contents, sizeof(contents));
+    BusPolicyWrite(BUS_TYPE_UDWORD, pages, address, &data);
   }
 }
 
 /* ============================================================================
- *  VR4300DStoreWordRight: Writes a doubleword to the DCache/Bus.
+ *  StoreDWordRight: Writes a doubleword to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreDWordRight(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+static const uint64_t StoreDWordRightMaskTable[8] = {
+  0x00FFFFFFFFFFFFFFULL,
+  0x0000FFFFFFFFFFFFULL,
+  0x000000FFFFFFFFFFULL,
+  0x00000000FFFFFFFFULL,
+  0x0000000000FFFFFFULL,
+  0x000000000000FFFFULL,
+  0x00000000000000FFULL,
+  0x0000000000000000ULL,
+};
+
+BUS_TEMPLATE void
+StoreDWordRight(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address & 0xFFFFFFF8;
-  uint64_t contents = memoryData->data;
+  unsigned type = memoryData->address & 0x7;
+  uint64_t contents = memoryData->data << ((7 - type) << 3);
   struct UnalignedData data;
-  MemoryFunction write;
-  void *opaque;
-
-  /* Pack the unaligned data structure. */
-  /* TODO/FIXME: Take endianness into account. */
-  data.size = (memoryData->address & 0x7) + 1;
-  contents = contents << ((8 - data.size) << 3);
-  contents = ByteOrderSwap64(contents);
-  memcpy(data.data, &contents, sizeof(contents));
 
   if (line != NULL) {
-    memcpy(line->data + (address & 0xF), data.data, data.size);
-    line->dirty = true;
+    uint8_t *dword = line->data + (address & 0x8);
+    uint64_t olddata;
+
+    memcpy(&olddata, dword, sizeof(olddata));
+    contents |= olddata & StoreDWordRightMaskTable[type];
+    memcpy(dword, &contents, sizeof(contents));
   }
 
+  /* Pack the unaligned data structure. */
+  /* TODO/FIXME: Take endianness into account. */
   else {
-    if ((write = BusWrite(bus, BUS_TYPE_UDWORD, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &data);
+    contents = ByteOrderSwap64(contents);
+    data.size = type + 1;
+    memcpy(data.data, &contents, sizeof(contents));
+    BusPolicyWrite(BUS_TYPE_UDWORD, pages, address, &data);
   }
 }
 
 /* ============================================================================
- *  VR4300StoreHWord: Writes a halfword to the DCache/Bus.
+ *  StoreHWord: Writes a halfword to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreHWord(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+StoreHWord(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
   uint16_t contents = memoryData->data;
-  MemoryFunction write;
-  void *opaque;
 
   if (line != NULL) {
-    contents = ByteOrderSwap16(contents);
-    memcpy(line->data + (address & 0xE), &contents, sizeof(contents));
-    line->dirty = true;
+    memcpy(line->data + ((address & 0xE) ^
+      VR4300_DCACHE_HWORD_XOR), &contents, sizeof(contents));
   }
 
-  else {
-    if ((write = BusWrite(bus, BUS_TYPE_HWORD, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &contents);
-  }
+  else
+    BusPolicyWrite(BUS_TYPE_HWORD, pages, address, &contents);
 }
 
 /* ============================================================================
- *  VR4300StoreWord: Writes a word to the DCache/Bus.
+ *  StoreWord: Writes a word to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreWord(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+BUS_TEMPLATE void
+StoreWord(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
   uint32_t contents = memoryData->data;
-  MemoryFunction write;
-  void *opaque;
 
   if (line != NULL) {
-    contents = ByteOrderSwap32(contents);
-    memcpy(line->data + (address & 0xC), &contents, sizeof(contents));
-    line->dirty = true;
+    memcpy(line->data + ((address & 0xC) ^
+      VR4300_DCACHE_WORD_XOR), &contents, sizeof(contents));
   }
 
-  else {
-    if ((write = BusWrite(bus, BUS_TYPE_WORD, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &contents);
-  }
+  else
+    BusPolicyWrite(BUS_TYPE_WORD, pages, address, &contents);
 }
 
 /* ============================================================================
- *  VR4300StoreWordLeft: Writes a word to the DCache/Bus.
+ *  StoreWordLeft: Writes a word to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreWordLeft(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+static const uint32_t StoreWordLeftMaskTable[4] = {
+  0x00000000,
+  0xFF000000,
+  0xFFFF0000,
+  0xFFFFFF00
+};
+
+BUS_TEMPLATE void
+StoreWordLeft(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address;
+  unsigned type = memoryData->address & 0x3;
   uint32_t contents = memoryData->data;
   struct UnalignedData data;
-  MemoryFunction write;
-  void *opaque;
-
-  /* Pack the unaligned data structure. */
-  /* TODO/FIXME: Take endianness into account. */
-  contents = ByteOrderSwap32(contents);
-  data.size = 4 - (memoryData->address & 0x3);
-  memcpy(data.data, &contents, sizeof(contents));
 
   if (line != NULL) {
-    memcpy(line->data + (address & 0xF), data.data, data.size);
-    line->dirty = true;
+    uint8_t *word = line->data + ((address & 0xC) ^ VR4300_DCACHE_WORD_XOR);
+    uint32_t olddata;
+
+    memcpy(&olddata, word, sizeof(olddata));
+    contents = (contents >> (type << 3)) |
+      (olddata & StoreWordLeftMaskTable[type]);
+    memcpy(word, &contents, sizeof(contents));
   }
 
+  /* Pack the unaligned data structure. */
+  /* TODO/FIXME: Take endianness into account. */
   else {
-    if ((write = BusWrite(bus, BUS_TYPE_UWORD, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &data);
+    contents = ByteOrderSwap32(contents);
+    data.size = 4 - type;
+    memcpy(data.data, &contents, sizeof(contents));
+    BusPolicyWrite(BUS_TYPE_UWORD, pages, address, &data);
   }
 }
 
 /* ============================================================================
- *  VR4300StoreWordRight: Writes a word to the DCache/Bus.
+ *  StoreWordRight: Writes a word to the DCache/Bus.
  * ========================================================================= */
-void
-VR4300StoreWordRight(const struct VR4300MemoryData *memoryData,
-  struct BusController *bus, struct VR4300DCacheLine *line) {
+static const uint32_t StoreWordRightMaskTable[4] = {
+  0x00FFFFFF,
+  0x0000FFFF,
+  0x000000FF,
+  0x00000000
+};
+
+BUS_TEMPLATE void
+StoreWordRight(const struct VR4300MemoryData *memoryData,
+  const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) {
   uint32_t address = memoryData->address & 0xFFFFFFFC;
-  uint32_t contents = memoryData->data;
+  unsigned type = memoryData->address & 0x3;
+  uint32_t contents = (uint32_t) memoryData->data << ((3 - type) << 3);
   struct UnalignedData data;
-  MemoryFunction write;
-  void *opaque;
-
-  /* Pack the unaligned data structure. */
-  /* TODO/FIXME: Take endianness into account. */
-  data.size = (memoryData->address & 0x3) + 1;
-  contents = contents << ((4 - data.size) << 3);
-  contents = ByteOrderSwap32(contents);
-  memcpy(data.data, &contents, sizeof(contents));
 
   if (line != NULL) {
-    memcpy(line->data + (address & 0xF), data.data, data.size);
-    line->dirty = true;
+    uint8_t *word = line->data + ((address & 0xC) ^ VR4300_DCACHE_WORD_XOR);
+    uint32_t olddata;
+
+    memcpy(&olddata, word, sizeof(olddata));
+    contents |= olddata & StoreWordRightMaskTable[type];
+    memcpy(word, &contents, sizeof(contents));
   }
 
+  /* Pack the unaligned data structure. */
+  /* TODO/FIXME: Take endianness into account. */
   else {
-    if ((write = BusWrite(bus, BUS_TYPE_UWORD, address, &opaque)) == NULL)
-      return;
-
-    write(opaque, address, &data);
+    contents = ByteOrderSwap32(contents);
+    data.size = type + 1;
+    memcpy(data.data, &contents, sizeof(contents));
+    BusPolicyWrite(BUS_TYPE_UWORD, pages, address, &data);
   }
 }
 
+/* ============================================================================
+ *  Exported memory functions; the instantiations over the bus policy.
+ * ========================================================================= */
+#define MEMORY_FUNCTIONS \
+  X(LoadByte) X(LoadByteU) X(LoadDWord) X(LoadDWordLeft) X(LoadDWordRight) \
+  X(LoadHWord) X(LoadHWordU) X(LoadWord) X(LoadWordFPU) X(LoadWordLeft) \
+  X(LoadWordRight) X(LoadWordU) X(StoreByte) X(StoreDWord) X(StoreDWordLeft) \
+  X(StoreDWordRight) X(StoreHWord) X(StoreWord) X(StoreWordLeft) \
+  X(StoreWordRight)
+
+#ifdef __cplusplus
+#define X(name) \
+  void VR4300##name(const struct VR4300MemoryData *memoryData, \
+    const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) { \
+    name<VR4300_BUS_POLICY>(memoryData, pages, line); \
+  }
+#else
+#define X(name) \
+  void VR4300##name(const struct VR4300MemoryData *memoryData, \
+    const struct VR4300PageTable *pages, struct VR4300DCacheLine *line) { \
+    name(memoryData, pages, line); \
+  }
+#endif
+
+MEMORY_FUNCTIONS
+#undef MEMORY_FUNCTIONS
+#undef X
+
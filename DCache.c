@@ -20,45 +20,83 @@
 #include <string.h>
 #endif
 
+static void SwapDWords(uint8_t *, const uint8_t *, size_t);
+
+/* ============================================================================
+ *  SwapDWords: Converts doublewords between big-endian and host byte order.
+ * ========================================================================= */
+static void
+SwapDWords(uint8_t *dest, const uint8_t *src, size_t size) {
+  size_t i;
+
+  for (i = 0; i < size; i += 8) {
+    uint64_t dword;
+
+    memcpy(&dword, src + i, sizeof(dword));
+    dword = ByteOrderSwap64(dword);
+    memcpy(dest + i, &dword, sizeof(dword));
+  }
+}
+
 /* ============================================================================
  *  Returns the data cache line and sets the tags.
  * ========================================================================= */
 void VR4300DCacheFill(struct VR4300DCache *dcache,
-  struct BusController *bus, uint64_t vaddr, uint32_t paddr) {
+  const struct VR4300PageTable *pages, uint64_t vaddr, uint32_t paddr) {
   unsigned lineIdx = vaddr >> 4 & 0x1FF;
-  unsigned ppo = paddr >> 4;
-  unsigned i;
-
   struct VR4300DCacheLine *line = dcache->lines + lineIdx;
-  paddr &= 0xFFFFFFF0;
 
   /* If the line is currently valid (and dirty), flush it out. */
-  if (dcache->valid[lineIdx] && line->dirty) {
-    MemoryFunction write;
-    uint32_t wraddr;
-    void *opaque;
-
-    wraddr = line->tag << 4;
-    write = BusWrite(bus, BUS_TYPE_WORD, wraddr, &opaque);
-
-    /* TODO: Why is if (write) needed? */
-    if (write) for (i = 0; i < 16; i += 4) {
-      uint32_t word;
-      memcpy(&word, line->data + i, sizeof(word));
-      word = ByteOrderSwap32(word);
-      write(opaque, wraddr + i, &word);
-    }
-  }
+  VR4300DCacheWriteBack(dcache, pages, lineIdx);
 
   /* Mark the line as valid. */
-  dcache->valid[lineIdx] = true;
-  line->dirty = false;
-  line->tag = ppo;
+  dcache->tags[lineIdx] = paddr >> 4 | VR4300_DCACHE_VALID;
+  paddr &= 0xFFFFFFF0;
 
   /* And fill it entirely. */
-  for (i = 0 ; i < 16; i += 4) {
-    uint32_t word = ByteOrderSwap32(BusReadWord(bus, paddr + i));
-    memcpy(line->data + i, &word, sizeof(word));
+  VR4300ReadLine(pages, paddr, line->data, sizeof(line->data));
+  SwapDWords(line->data, line->data, sizeof(line->data));
+}
+
+/* ============================================================================
+ *  Invalidates every line, dropping the contents of any dirty ones.
+ * ========================================================================= */
+void VR4300DCacheInvalidateAll(struct VR4300DCache *dcache) {
+  memset(dcache->tags, 0, sizeof(dcache->tags));
+  memset(dcache->dirty, 0, sizeof(dcache->dirty));
+}
+
+/* ============================================================================
+ *  Invalidates any clean line that holds part of a physical address range.
+ *  Dirty lines are left alone, as their contents are newer than memory's.
+ *  Only bit 12 of the (virtual) index can differ from the physical address,
+ *  so a line can only be in one of two slots; past a page, it's cheaper to
+ *  just look at all of them.
+ * ========================================================================= */
+void VR4300DCacheInvalidateRange(struct VR4300DCache *dcache,
+  uint32_t paddr, uint32_t length) {
+  uint32_t address, end = paddr + length;
+  unsigned i;
+
+  if (length >= 4096) {
+    for (i = 0; i < VR4300_DCACHE_LINES; i++) {
+      address = dcache->tags[i] << 4;
+
+      if ((dcache->tags[i] & VR4300_DCACHE_VALID) &&
+        !(dcache->dirty[i >> 5] & (1U << (i & 0x1F))) &&
+        address + 16 > paddr && address < end)
+        dcache->tags[i] &= ~VR4300_DCACHE_VALID;
+    }
+
+    return;
+  }
+
+  for (address = paddr & ~0xFU; address < end; address += 16) {
+    for (i = address >> 4 & 0xFF; i < VR4300_DCACHE_LINES; i += 256) {
+      if (dcache->tags[i] == (address >> 4 | VR4300_DCACHE_VALID) &&
+        !(dcache->dirty[i >> 5] & (1U << (i & 0x1F))))
+        dcache->tags[i] &= ~VR4300_DCACHE_VALID;
+    }
   }
 }
 
@@ -67,22 +105,54 @@ void VR4300DCacheFill(struct VR4300DCache *dcache,
  * ========================================================================= */
 struct VR4300DCacheLine* VR4300DCacheProbe(
   struct VR4300DCache *dcache, uint64_t vaddr, uint32_t paddr) {
-  struct VR4300DCacheLine *line;
   unsigned lineIdx = vaddr >> 4 & 0x1FF;
-  unsigned ppo = paddr >> 4;
 
   /* Virtually indexed, physically tagged. */
-  line = dcache->lines + lineIdx;
-  if (!dcache->valid[lineIdx] || line->tag != ppo)
+  if (dcache->tags[lineIdx] != (paddr >> 4 | VR4300_DCACHE_VALID))
     return NULL;
 
-  return line;
+  return dcache->lines + lineIdx;
 }
 
 /* ============================================================================
- *  Initializes the instruction cache, invalidating all lines.
+ *  Writes a line back to memory if it's valid and dirty; it stays valid.
  * ========================================================================= */
-void VR4300InitDCache(struct VR4300DCache *dcache) {
-  memset(dcache->valid, 0, sizeof(dcache->valid));
+void VR4300DCacheWriteBack(struct VR4300DCache *dcache,
+  const struct VR4300PageTable *pages, unsigned lineIdx) {
+  uint32_t *dirty = dcache->dirty + (lineIdx >> 5);
+  uint32_t bit = 1U << (lineIdx & 0x1F);
+  uint8_t data[sizeof(dcache->lines[0].data)];
+
+  if (!(*dirty & bit))
+    return;
+
+  *dirty &= ~bit;
+
+  if (dcache->tags[lineIdx] & VR4300_DCACHE_VALID) {
+    SwapDWords(data, dcache->lines[lineIdx].data, sizeof(data));
+    VR4300WriteLine(pages, dcache->tags[lineIdx] << 4, data, sizeof(data));
+  }
 }
 
+/* ============================================================================
+ *  Writes every dirty line back to memory, skipping over clean ones a word
+ *  of the dirty bitmap at a time.
+ * ========================================================================= */
+void VR4300DCacheWriteBackAll(struct VR4300DCache *dcache,
+  const struct VR4300PageTable *pages) {
+  unsigned i, j;
+
+  for (i = 0; i < VR4300_DCACHE_LINES / 32; i++) {
+    for (j = 0; dcache->dirty[i] != 0; j++) {
+      if (dcache->dirty[i] & (1U << j))
+        VR4300DCacheWriteBack(dcache, pages, i << 5 | j);
+    }
+  }
+}
+
+/* ============================================================================
+ *  Initializes the data cache, invalidating all lines.
+ * ========================================================================= */
+void VR4300InitDCache(struct VR4300DCache *dcache) {
+  VR4300DCacheInvalidateAll(dcache);
+}
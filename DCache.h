@@ -13,24 +13,68 @@
 #include "Common.h"
 #include "Decoder.h"
 #include "Externs.h"
+#include "PageTable.h"
+
+/* Lines hold two doublewords in host byte order. Smaller units are found */
+/* by flipping the low bits of their offset on little-endian hosts. */
+#ifdef LITTLE_ENDIAN
+#define VR4300_DCACHE_BYTE_XOR 0x7
+#define VR4300_DCACHE_HWORD_XOR 0x6
+#define VR4300_DCACHE_WORD_XOR 0x4
+#else
+#define VR4300_DCACHE_BYTE_XOR 0x0
+#define VR4300_DCACHE_HWORD_XOR 0x0
+#define VR4300_DCACHE_WORD_XOR 0x0
+#endif
+
+#define VR4300_DCACHE_LINES 512
+
+/* Tags are the physical line number with the valid bit folded in. */
+#define VR4300_DCACHE_VALID 0x80000000U
 
 struct VR4300DCacheLine {
   uint8_t data[16];
-  uint32_t tag;
-  bool dirty;
 };
 
+/* Aligned, so that no line straddles a host cache line. */
 struct VR4300DCache {
-  struct VR4300DCacheLine lines[512];
-  bool valid[512];
+  struct VR4300DCacheLine lines[VR4300_DCACHE_LINES] align(16);
+  uint32_t tags[VR4300_DCACHE_LINES];
+  uint32_t dirty[VR4300_DCACHE_LINES / 32];
 };
 
 void VR4300InitDCache(struct VR4300DCache *dcache);
 void VR4300DCacheFill(struct VR4300DCache *dcache,
-  struct BusController *bus, uint64_t vaddr, uint32_t paddr);
+  const struct VR4300PageTable *pages, uint64_t vaddr, uint32_t paddr);
+void VR4300DCacheInvalidateAll(struct VR4300DCache *dcache);
+void VR4300DCacheInvalidateRange(struct VR4300DCache *dcache,
+  uint32_t paddr, uint32_t length);
+void VR4300DCacheWriteBack(struct VR4300DCache *dcache,
+  const struct VR4300PageTable *pages, unsigned lineIdx);
+void VR4300DCacheWriteBackAll(struct VR4300DCache *dcache,
+  const struct VR4300PageTable *pages);
 
 struct VR4300DCacheLine* VR4300DCacheProbe(
   struct VR4300DCache *dcache, uint64_t vaddr, uint32_t paddr);
 
+/* ============================================================================
+ *  Invalidates a line, dropping its contents even if they're dirty.
+ * ========================================================================= */
+static inline void VR4300DCacheInvalidateLine(
+  struct VR4300DCache *dcache, unsigned lineIdx) {
+  dcache->tags[lineIdx] &= ~VR4300_DCACHE_VALID;
+  dcache->dirty[lineIdx >> 5] &= ~(1U << (lineIdx & 0x1F));
+}
+
+/* ============================================================================
+ *  Marks a line (as returned by a probe) as dirty.
+ * ========================================================================= */
+static inline void VR4300DCacheMarkDirty(
+  struct VR4300DCache *dcache, const struct VR4300DCacheLine *line) {
+  unsigned lineIdx = line - dcache->lines;
+
+  dcache->dirty[lineIdx >> 5] |= 1U << (lineIdx & 0x1F);
+}
+
 #endif
 
@@ -18,6 +18,16 @@
 #include <string.h>
 #endif
 
+static const struct VR4300Opcode *SpecializeOpcode(
+  uint32_t, const struct VR4300Opcode *);
+
+/* C++ builds flatten the tables below at compile time; see the end. */
+#ifdef __cplusplus
+#define DECODER_TABLE static constexpr
+#else
+#define DECODER_TABLE static const
+#endif
+
 /* ============================================================================
  *  Escaped opcode table: Special.
  *
@@ -36,7 +46,7 @@
  *      |-------|-------|-------|-------|-------|-------|-------|-------|
  *
  * ========================================================================= */
-static const struct VR4300Opcode SpecialOpcodeTable[64] = {
+DECODER_TABLE struct VR4300Opcode SpecialOpcodeTable[64] = {
   {SLL},     {INVALID}, {SRL},     {SRA},
   {SLLV},    {INVALID}, {SRLV},    {SRAV},
   {JR},      {JALR},    {INVALID}, {INVALID},
@@ -69,7 +79,7 @@ static const struct VR4300Opcode SpecialOpcodeTable[64] = {
  *      |-------|-------|-------|-------|-------|-------|-------|-------|
  *
  * ========================================================================= */
-static const struct VR4300Opcode RegImmOpcodeTable[32] = {
+DECODER_TABLE struct VR4300Opcode RegImmOpcodeTable[32] = {
   {BLTZ},    {BGEZ},    {BLTZL},   {BGEZL},
   {INVALID}, {INVALID}, {INVALID}, {INVALID},
   {TGEI},    {TGEIU},   {TLTI},    {TLTIU},
@@ -93,7 +103,7 @@ static const struct VR4300Opcode RegImmOpcodeTable[32] = {
  *   11 |  ---  |  ---  |  ---  |  ---  |  ---  |  ---  |  ---  |  ---  |
  *      |-------|-------|-------|-------|-------|-------|-------|-------|
  * ========================================================================= */
-static const struct VR4300Opcode COP0OpcodeTable[32] = {
+DECODER_TABLE struct VR4300Opcode COP0OpcodeTable[32] = {
   {MFC0},    {DMFC0},   {CFC0},    {INVALID},
   {MTC0},    {DMTC0},   {CTC0},    {INVALID},
   {BC0},     {INVALID}, {INVALID}, {INVALID},
@@ -117,7 +127,7 @@ static const struct VR4300Opcode COP0OpcodeTable[32] = {
  *   11 |  ---  |  ---  |  ---  |  ---  |  ---  |  ---  |  ---  |  ---  |
  *      |-------|-------|-------|-------|-------|-------|-------|-------|
  * ========================================================================= */
-static const struct VR4300Opcode COP1OpcodeTable[32] = {
+DECODER_TABLE struct VR4300Opcode COP1OpcodeTable[32] = {
   {MFC1},    {DMFC1},   {CFC1},    {INVALID},
   {MTC1},    {DMTC1},   {CTC1},    {INVALID},
   {BC1},     {INVALID}, {INVALID}, {INVALID},
@@ -143,7 +153,7 @@ static const struct VR4300Opcode COP1OpcodeTable[32] = {
  *      |-------|-------|-------|-------|-------|-------|-------|-------|
  *
  * ========================================================================= */
-static const struct VR4300Opcode COP2OpcodeTable[32] = {
+DECODER_TABLE struct VR4300Opcode COP2OpcodeTable[32] = {
   {MFC2},    {DMFC2},   {CFC2},    {INVALID},
   {MTC2},    {DMTC2},   {CTC2},    {INVALID},
   {BC2},     {INVALID}, {INVALID}, {INVALID},
@@ -178,7 +188,7 @@ static const struct VR4300Opcode COP2OpcodeTable[32] = {
  *      |-------|-------|-------|-------|-------|-------|-------|-------|
  *
  * ========================================================================= */
-static const struct VR4300Opcode OpcodeTable[64] = {
+DECODER_TABLE struct VR4300Opcode OpcodeTable[64] = {
   {INVALID}, {INVALID}, {J},       {JAL},
   {BEQ},     {BNE},     {BLEZ},    {BGTZ},
   {ADDI},    {ADDIU},   {SLTI},    {SLTIU},
@@ -199,7 +209,7 @@ static const struct VR4300Opcode OpcodeTable[64] = {
 
 /* Escaped table listings. Most of these will never */
 /* see a processor cacheline, so not much waste here. */
-static const struct VR4300OpcodeEscape EscapeTable[64] = {
+DECODER_TABLE struct VR4300OpcodeEscape EscapeTable[64] = {
   {SpecialOpcodeTable,  0, 0x3F}, {RegImmOpcodeTable,  16, 0x1F},
   {OpcodeTable,        26, 0x3F}, {OpcodeTable,        26, 0x3F},
   {OpcodeTable,        26, 0x3F}, {OpcodeTable,        26, 0x3F},
@@ -241,16 +251,165 @@ static const struct VR4300OpcodeEscape EscapeTable[64] = {
   {OpcodeTable,        26, 0x3F}, {OpcodeTable,        26, 0x3F},
 };
 
+/* Operand-specialized forms, handed out by SpecializeOpcode. */
+static const struct VR4300Opcode BOpcode = {B};
+static const struct VR4300Opcode LIOpcode = {LI};
+static const struct VR4300Opcode MOVEOpcode = {MOVE};
+static const struct VR4300Opcode NOPOpcode = {NOP};
+
+/* ============================================================================
+ *  SpecializeOpcode: Swaps in a leaner opcode for common operand patterns.
+ *  Anything that would only write $zero (and can't trap) becomes a NOP.
+ * ========================================================================= */
+static const struct VR4300Opcode *
+SpecializeOpcode(uint32_t iw, const struct VR4300Opcode *opcode) {
+  unsigned rs = GET_RS(iw), rt = GET_RT(iw), rd = GET_RD(iw);
+
+  switch (opcode->id) {
+    case VR4300_OPCODE_BEQ_BEQL_BNE_BNEL:
+      return !(iw >> 26 & 0x1) && !rs && !rt ? &BOpcode : opcode;
+
+    case VR4300_OPCODE_DADDU:
+    case VR4300_OPCODE_OR:
+      if (!rd)
+        return &NOPOpcode;
+
+      return !rt ? &MOVEOpcode : opcode;
+
+    /* ADDI can overflow; only ADDIU is safe to rewrite. */
+    case VR4300_OPCODE_ADDI_SUBI_ADDIU_SUBIU:
+      if (!(iw >> 26 & 0x1))
+        return opcode;
+
+      /* Fallthrough. */
+
+    case VR4300_OPCODE_DADDIU:
+      if (!rt)
+        return &NOPOpcode;
+
+      return !rs ? &LIOpcode : opcode;
+
+    /* Same deal with ADD and SUB. */
+    case VR4300_OPCODE_ADD_ADDU_SUB_SUBU:
+      return !rd && (iw & 0x1) ? &NOPOpcode : opcode;
+
+    case VR4300_OPCODE_AND: case VR4300_OPCODE_DSLL:
+    case VR4300_OPCODE_DSLL32: case VR4300_OPCODE_DSLLV:
+    case VR4300_OPCODE_DSRA: case VR4300_OPCODE_DSRA32:
+    case VR4300_OPCODE_DSRAV: case VR4300_OPCODE_DSRL:
+    case VR4300_OPCODE_DSRL32: case VR4300_OPCODE_DSRLV:
+    case VR4300_OPCODE_DSUBU: case VR4300_OPCODE_MFHI:
+    case VR4300_OPCODE_MFLO: case VR4300_OPCODE_NOR:
+    case VR4300_OPCODE_SLL: case VR4300_OPCODE_SLLV:
+    case VR4300_OPCODE_SLT: case VR4300_OPCODE_SLTU:
+    case VR4300_OPCODE_SRA: case VR4300_OPCODE_SRAV:
+    case VR4300_OPCODE_SRL: case VR4300_OPCODE_SRLV:
+    case VR4300_OPCODE_XOR:
+      return !rd ? &NOPOpcode : opcode;
+
+    case VR4300_OPCODE_ANDI: case VR4300_OPCODE_LUI:
+    case VR4300_OPCODE_ORI: case VR4300_OPCODE_SLTI:
+    case VR4300_OPCODE_SLTIU: case VR4300_OPCODE_XORI:
+      return !rt ? &NOPOpcode : opcode;
+
+    default:
+      break;
+  }
+
+  return opcode;
+}
+
+/* ============================================================================
+ *  Flattened opcode table (C++ builds only).
+ *
+ *  Row `OPCODE` of the table has whatever the escape tables give for every
+ *  value of the field that the opcode escapes on (the function field for
+ *  SPECIAL, rt for RegImm and rs for COP0, COP1 and COP2); other rows
+ *  repeat the first-order entry. That's 64x64 entries, computed by the
+ *  compiler from the tables above, so the two can't disagree (make check
+ *  compares them over every encoding). Looking up an instruction in it
+ *  takes one load.
+ * ========================================================================= */
+#ifdef __cplusplus
+#define FLAT_OPCODE_TABLE_SIZE (64 * 64)
+
+struct FlatOpcodeTable {
+  struct VR4300Opcode entries[FLAT_OPCODE_TABLE_SIZE];
+};
+
+/* C++11 has no std::index_sequence, so build 0 ... Count-1 by halves. */
+template <unsigned... Index> struct DecoderIndices {};
+
+template <class Low, class High> struct JoinDecoderIndices;
+template <unsigned... Low, unsigned... High>
+struct JoinDecoderIndices<DecoderIndices<Low...>, DecoderIndices<High...> > {
+  typedef DecoderIndices<Low..., (sizeof...(Low) + High)...> type;
+};
+
+template <unsigned Count> struct MakeDecoderIndices {
+  typedef typename JoinDecoderIndices<
+    typename MakeDecoderIndices<Count / 2>::type,
+    typename MakeDecoderIndices<Count - Count / 2>::type>::type type;
+};
+
+template <> struct MakeDecoderIndices<0> {
+  typedef DecoderIndices<> type;
+};
+
+template <> struct MakeDecoderIndices<1> {
+  typedef DecoderIndices<0> type;
+};
+
+/* ============================================================================
+ *  FlatOpcodeEntry: Returns what the escape tables decode for a row and
+ *  column of the flattened table.
+ * ========================================================================= */
+static constexpr struct VR4300Opcode
+FlatOpcodeEntry(unsigned index) {
+  return EscapeTable[index >> 6].shift == 26
+    ? OpcodeTable[index >> 6]
+    : EscapeTable[index >> 6].table[index & EscapeTable[index >> 6].mask];
+}
+
+template <unsigned... Index>
+static constexpr struct FlatOpcodeTable
+BuildFlatOpcodeTable(DecoderIndices<Index...>) {
+  return FlatOpcodeTable{{FlatOpcodeEntry(Index)...}};
+}
+
+static constexpr struct FlatOpcodeTable FlatTable = BuildFlatOpcodeTable(
+  MakeDecoderIndices<FLAT_OPCODE_TABLE_SIZE>::type());
+
+/* ============================================================================
+ *  FlatOpcodeIndex: Returns the row and column of an instruction word. The
+ *  column is the field that the opcode escapes on, if it does. No loads.
+ * ========================================================================= */
+static inline unsigned
+FlatOpcodeIndex(uint32_t iw) {
+  unsigned opcode = iw >> 26;
+  unsigned field =
+    opcode == 0x00 ? (iw & 0x3F) :
+    opcode == 0x01 ? (iw >> 16 & 0x1F) :
+    opcode - 0x10 < 3 ? (iw >> 21 & 0x1F) : 0;
+
+  return opcode << 6 | field;
+}
+#endif
+
 /* ============================================================================
  *  VR4300DecodeInstruction: Looks up an instruction in the opcode table.
  *  Instruction words are assumed to be in big-endian byte order.
  * ========================================================================= */
 const struct VR4300Opcode*
 VR4300DecodeInstruction(uint32_t iw) {
+#ifdef __cplusplus
+  return SpecializeOpcode(iw, &FlatTable.entries[FlatOpcodeIndex(iw)]);
+#else
   const struct VR4300OpcodeEscape *escape = &EscapeTable[iw >> 26];
   unsigned index = iw >> escape->shift & escape->mask;
 
-  return &escape->table[index];
+  return SpecializeOpcode(iw, &escape->table[index]);
+#endif
 }
 
 /* ============================================================================
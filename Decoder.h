@@ -41,6 +41,11 @@ struct VR4300Opcode {
   uint32_t flags;
 };
 
+/* Register fields, extracted once when the instruction is fetched. */
+struct VR4300Operands {
+  uint8_t rs, rt, rd, sa;
+};
+
 /* Escape table data. */
 struct VR4300OpcodeEscape {
   const struct VR4300Opcode *table;
@@ -50,5 +55,16 @@ struct VR4300OpcodeEscape {
 const struct VR4300Opcode* VR4300DecodeInstruction(uint32_t);
 void VR4300InvalidateOpcode(struct VR4300Opcode *);
 
+/* ============================================================================
+ *  VR4300DecodeOperands: Extracts the register fields of an instruction.
+ * ========================================================================= */
+static inline void
+VR4300DecodeOperands(uint32_t iw, struct VR4300Operands *operands) {
+  operands->rs = GET_RS(iw);
+  operands->rt = GET_RT(iw);
+  operands->rd = GET_RD(iw);
+  operands->sa = iw >> 6 & 0x1F;
+}
+
 #endif
 
@@ -13,6 +13,7 @@
 #include "Decoder.h"
 #include "EXStage.h"
 #include "Fault.h"
+#include "IdleLoop.h"
 #include "Pipeline.h"
 #include "Region.h"
 
@@ -36,6 +37,16 @@ static const uint32_t vr4300_branch_lut[2] = {
   ~0U, 0U
 };
 
+#ifdef DO_FASTFORWARD
+// Hand short backward branches to the idle loop detector.
+static inline void vr4300_check_idle_loop(
+  struct VR4300 *vr4300, uint64_t offset) {
+  if ((int64_t) offset < 0 &&
+    (int64_t) offset >= -VR4300_IDLE_LOOP_MAX_BYTES)
+    VR4300DetectIdleLoop(vr4300);
+}
+#endif
+
 //
 // ADD
 // ADDU
@@ -52,7 +63,7 @@ void VR4300ADD_ADDU_SUB_SUBU(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   unsigned dest;
   uint64_t rd;
 
-  dest = GET_RD(iw);
+  dest = rfex_latch->operands.rd;
   rt = (rt ^ mask) - mask;
   rd = rs + rt;
 
@@ -77,7 +88,7 @@ void VR4300ADDI_SUBI_ADDIU_SUBIU(struct VR4300 *vr4300, uint64_t rs, uint64_t rt
 
   unsigned dest;
 
-  dest = GET_RT(iw);
+  dest = rfex_latch->operands.rt;
   rt = (int16_t) iw;
   rt = (rt ^ mask) - mask;
   rt = rs + rt;
@@ -96,7 +107,7 @@ VR4300AND(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = rs & rt;
   exdcLatch->result.dest = dest;
@@ -110,13 +121,39 @@ VR4300ANDI(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   uint16_t imm = rfexLatch->iw;
 
   exdcLatch->result.data = rs & imm;
   exdcLatch->result.dest = dest;
 }
 
+/* ============================================================================
+ *  Instruction: B (Branch; BEQ/BEQL $zero, $zero)
+ * ========================================================================= */
+void
+VR4300B(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
+  struct VR4300ICRFLatch *icrfLatch = &vr4300->pipeline.icrfLatch;
+  const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
+
+  uint32_t iw = rfexLatch->iw;
+  uint64_t offset = (int16_t) iw << 2;
+
+#ifdef DO_FASTFORWARD
+  if (offset == 0xFFFFFFFFFFFFFFFCULL && !(iw >> 30 & 0x1)) {
+    if (vr4300->pipeline.faultManager.excpIndex == VR4300_PCU_NORMAL) {
+      vr4300->pipeline.faultManager.excpIndex = VR4300_PCU_FASTFORWARD;
+      vr4300->pipeline.faultManager.faulting = 1;
+    }
+  }
+
+  else
+    vr4300_check_idle_loop(vr4300, offset);
+#endif
+
+  icrfLatch->pc += offset - 4;
+}
+
 /* ============================================================================
  *  Instruction: BC2 (Branch On Coprocessor 2 Instructions)
  * ========================================================================= */
@@ -149,11 +186,15 @@ void VR4300BEQ_BEQL_BNE_BNEL(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   }
 
 #ifdef DO_FASTFORWARD
-  if (offset == 0xFFFFFFFFFFFFFFFCULL && !rs && !(iw >> 30 & 0x1))
+  if (offset == 0xFFFFFFFFFFFFFFFCULL && !rs && !(iw >> 30 & 0x1)) {
     if (vr4300->pipeline.faultManager.excpIndex == VR4300_PCU_NORMAL) {
       vr4300->pipeline.faultManager.excpIndex = VR4300_PCU_FASTFORWARD;
       vr4300->pipeline.faultManager.faulting = 1;
     }
+  }
+
+  else
+    vr4300_check_idle_loop(vr4300, offset);
 #endif
 
   icrf_latch->pc += offset - 4;
@@ -182,6 +223,10 @@ void VR4300BGEZ_BGEZL_BLTZ_BLTZL(
     return;
   }
 
+#ifdef DO_FASTFORWARD
+  vr4300_check_idle_loop(vr4300, offset);
+#endif
+
   icrf_latch->pc += offset - 4;
 }
 
@@ -238,6 +283,10 @@ void VR4300BGTZ_BGTZL_BLEZ_BLEZL(
     return;
   }
 
+#ifdef DO_FASTFORWARD
+  vr4300_check_idle_loop(vr4300, offset);
+#endif
+
   icrf_latch->pc += (offset - 4);
 }
 
@@ -268,11 +317,12 @@ VR4300CACHE(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   uint32_t paddr;
 
   /* Perform address translation to get address. */
-  if ((region = GetRegionInfo(vr4300, address)) == NULL) {
+  if ((region = VR4300LookupRegion(vr4300, address)) == NULL) {
     debug("Unimplemented fault: VR4300_FAULT_IADE.");
     return;
   }
 
+  VR4300IdleLoopSideEffect(vr4300);
   cache = rfexLatch->iw >> 16 & 0x3;
   op = rfexLatch->iw >> 18 & 0x7;
   address -= region->offset;
@@ -281,7 +331,7 @@ VR4300CACHE(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   if (region->mapped) {
     debugarg("TLB CACHE Access: Address: 0x%.16lX.", address);
 
-    if (!VR4300Translate(vr4300, address, &paddr)) {
+    if (!VR4300TranslateData(vr4300, address, &paddr)) {
       debugarg("TLB Miss: Address: 0x%.16lX.", address);
       debug("Unimplemented fault: VR4300_TLB_...");
     }
@@ -296,22 +346,26 @@ VR4300CACHE(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
 
     switch(op) {
       case 0: /* Index_Invalidate */
-        icache->valid[idx] = 0;
+        VR4300FlushBlocks(&vr4300->blockCache);
+        icache->tags[idx] &= ~VR4300_ICACHE_VALID;
         break;
 
       case 1: /* Index_Load_Tag */
-        cp0->regs.tagLo.pState = icache->valid[idx] << 1;
-        cp0->regs.tagLo.pTagLo = icache->lines[idx].tag;
+        cp0->regs.tagLo.pState = icache->tags[idx] >> 31 << 1;
+        cp0->regs.tagLo.pTagLo = icache->tags[idx] & ~VR4300_ICACHE_VALID;
         break;
 
       case 2: /* Index_Store_Tag */
-        icache->valid[idx] = cp0->regs.tagLo.pState >> 1;
-        icache->lines[idx].tag = cp0->regs.tagLo.pTagLo;
+        VR4300FlushBlocks(&vr4300->blockCache);
+        icache->tags[idx] = cp0->regs.tagLo.pTagLo |
+          (cp0->regs.tagLo.pState >> 1 ? VR4300_ICACHE_VALID : 0);
         break;
 
       case 4: /* Hit_Invalidate */
-        if (icache->lines[idx].tag == (paddr >> 12))
-          icache->valid[idx] = 0;
+        VR4300InvalidateBlocks(&vr4300->blockCache, paddr & ~0x1FU, 32);
+
+        if (icache->tags[idx] == (paddr >> 12 | VR4300_ICACHE_VALID))
+          icache->tags[idx] &= ~VR4300_ICACHE_VALID;
         break;
 
       case 5: /* Fill; no need to resume from EX... */
@@ -333,30 +387,26 @@ VR4300CACHE(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
 
     switch (op) {
       case 0: /* Index_Write_Back_Invalidate */
-        if (dcache->valid[idx]) {
-          dcache->lines[idx].dirty = true;
-          VR4300DCacheFill(dcache, vr4300->bus, address, paddr);
-        }
-
-        dcache->valid[idx] = false;
+        VR4300DCacheWriteBack(dcache, &vr4300->pageTable, idx);
+        VR4300DCacheInvalidateLine(dcache, idx);
         break;
 
       case 4: /* Hit_Invalidate */
-        if (dcache->lines[idx].tag == (paddr >> 4))
-          dcache->valid[idx] = false;
+        if (dcache->tags[idx] == (paddr >> 4 | VR4300_DCACHE_VALID))
+          VR4300DCacheInvalidateLine(dcache, idx);
         break;
 
       case 5: /* Hit_Write_Back_Invalidate */
-        if (dcache->lines[idx].tag == (paddr >> 4)) {
-          VR4300DCacheFill(dcache, vr4300->bus, address, paddr);
-          dcache->valid[idx] = false;
+        if (dcache->tags[idx] == (paddr >> 4 | VR4300_DCACHE_VALID)) {
+          VR4300DCacheWriteBack(dcache, &vr4300->pageTable, idx);
+          VR4300DCacheInvalidateLine(dcache, idx);
         }
 
         break;
 
       case 6: /* Hit_Write_Back */
-        if (dcache->lines[idx].tag == (paddr >> 4))
-          VR4300DCacheFill(dcache, vr4300->bus, address, paddr);
+        if (dcache->tags[idx] == (paddr >> 4 | VR4300_DCACHE_VALID))
+          VR4300DCacheWriteBack(dcache, &vr4300->pageTable, idx);
         break;
 
       default:
@@ -415,7 +465,7 @@ VR4300DADD(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rs + rt;
 
   exdcLatch->result.data = result;
@@ -431,7 +481,7 @@ VR4300DADDI(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   int64_t result = rs + imm;
 
@@ -447,7 +497,7 @@ VR4300DADDIU(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   int64_t result = rs + imm;
 
@@ -463,7 +513,7 @@ VR4300DADDU(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   int64_t result = rs + rt;
 
   exdcLatch->result.data = result;
@@ -622,8 +672,8 @@ VR4300DSLL(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = rfexLatch->iw >> 6 & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa;
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rt << sa;
 
   exdcLatch->result.data = result;
@@ -639,7 +689,7 @@ VR4300DSLLV(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
   unsigned sa = rs & 0x3F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rt << sa;
 
   exdcLatch->result.data = result;
@@ -654,8 +704,8 @@ VR4300DSLL32(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = (rfexLatch->iw >> 6 & 0x1F) + 32;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa + 32;
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rt << sa;
 
   exdcLatch->result.data = result;
@@ -670,8 +720,8 @@ VR4300DSRA(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = rfexLatch->iw >> 6 & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa;
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = (int64_t) rt >> sa;
 
   exdcLatch->result.data = result;
@@ -687,7 +737,7 @@ VR4300DSRAV(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
   unsigned sa = rs & 0x3F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = (int64_t) rt >> sa;
 
   exdcLatch->result.data = result;
@@ -702,8 +752,8 @@ VR4300DSRA32(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = (rfexLatch->iw >> 6 & 0x1F) + 32;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa + 32;
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = (int64_t) rt >> sa;
 
   exdcLatch->result.data = result;
@@ -718,8 +768,8 @@ VR4300DSRL(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = rfexLatch->iw >> 6 & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa;
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rt >> sa;
 
   exdcLatch->result.data = result;
@@ -735,7 +785,7 @@ VR4300DSRLV(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
   unsigned sa = rs & 0x3F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rt >> sa;
 
   exdcLatch->result.data = result;
@@ -750,8 +800,8 @@ VR4300DSRL32(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = (rfexLatch->iw >> 6 & 0x1F) + 32;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa + 32;
+  unsigned dest = rfexLatch->operands.rd;
   uint64_t result = rt >> sa;
 
   exdcLatch->result.data = result;
@@ -767,7 +817,7 @@ VR4300DSUB(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   int64_t result = rs - rt;
 
   exdcLatch->result.data = result;
@@ -782,7 +832,7 @@ VR4300DSUBU(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   int64_t result = rs - rt;
 
   exdcLatch->result.data = result;
@@ -874,7 +924,7 @@ VR4300LB(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -894,7 +944,7 @@ VR4300LBU(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -914,7 +964,7 @@ VR4300LD(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -947,7 +997,7 @@ VR4300LDL(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -968,7 +1018,7 @@ VR4300LDR(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -989,7 +1039,7 @@ VR4300LH(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -1013,7 +1063,7 @@ VR4300LHU(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -1028,6 +1078,18 @@ VR4300LHU(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   exdcLatch->result.dest = dest;
 }
 
+/* ============================================================================
+ *  Instruction: LI (Load Immediate; (D)ADDIU rt, $zero, imm)
+ * ========================================================================= */
+void
+VR4300LI(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
+  const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
+  struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
+
+  exdcLatch->result.data = (int16_t) rfexLatch->iw;
+  exdcLatch->result.dest = rfexLatch->operands.rt;
+}
+
 /* ============================================================================
  *  Instruction: LL (Load Linked)
  * ========================================================================= */
@@ -1054,7 +1116,7 @@ VR4300LUI(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)){
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int32_t) (rfexLatch->iw << 16);
 
   exdcLatch->result.data = imm;
@@ -1070,7 +1132,7 @@ VR4300LW(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -1103,7 +1165,7 @@ VR4300LWL(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -1124,7 +1186,7 @@ VR4300LWR(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -1145,7 +1207,7 @@ VR4300LWU(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
   struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
   uint64_t address = rs + imm;
 
@@ -1177,7 +1239,7 @@ VR4300MFHI(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = vr4300->regs[VR4300_REGISTER_HI];
   exdcLatch->result.dest = dest;
@@ -1191,12 +1253,24 @@ VR4300MFLO(struct VR4300 *vr4300,uint64_t unused(rs), uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = vr4300->regs[VR4300_REGISTER_LO];
   exdcLatch->result.dest = dest;
 }
 
+/* ============================================================================
+ *  Instruction: MOVE (Move; OR/DADDU rd, rs, $zero)
+ * ========================================================================= */
+void
+VR4300MOVE(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
+  const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
+  struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
+
+  exdcLatch->result.data = rs;
+  exdcLatch->result.dest = rfexLatch->operands.rd;
+}
+
 /* ============================================================================
  *  Instruction: MTC2 (Move To Coprocessor 2)
  * ========================================================================= */
@@ -1256,6 +1330,15 @@ VR4300MULTU(struct VR4300 *vr4300, uint64_t _rs, uint64_t _rt) {
   vr4300->regs[VR4300_REGISTER_HI] = (int64_t) hi;
 }
 
+/* ============================================================================
+ *  Instruction: NOP (No Operation; anything that only writes $zero)
+ *  The result latch was already invalidated by EX; leave it that way.
+ * ========================================================================= */
+void
+VR4300NOP(struct VR4300 *unused(vr4300),
+  uint64_t unused(rs), uint64_t unused(rt)) {
+}
+
 /* ============================================================================
  *  Instruction: NOR (Nor)
  * ========================================================================= */
@@ -1264,7 +1347,7 @@ VR4300NOR(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = ~(rs | rt);
   exdcLatch->result.dest = dest;
@@ -1278,7 +1361,7 @@ VR4300OR(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = rs | rt;
   exdcLatch->result.dest = dest;
@@ -1292,7 +1375,7 @@ VR4300ORI(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   uint16_t imm = rfexLatch->iw;
 
   exdcLatch->result.data = rs | imm;
@@ -1422,8 +1505,8 @@ VR4300SLL(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = rfexLatch->iw >> 6 & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa;
+  unsigned dest = rfexLatch->operands.rd;
   int64_t result = (int32_t) (rt << sa);
 
   exdcLatch->result.data = result;
@@ -1439,7 +1522,7 @@ VR4300SLLV(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
   unsigned sa = rs & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   int64_t result = (int32_t) (rt << sa);
 
   exdcLatch->result.data = result;
@@ -1454,7 +1537,7 @@ VR4300SLT(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = ((int64_t) rs < (int64_t) rt) ? 1 : 0;
   exdcLatch->result.dest = dest;
@@ -1468,7 +1551,7 @@ VR4300SLTI(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
 
   exdcLatch->result.data = ((int64_t) rs < imm) ? 1 : 0;
@@ -1483,7 +1566,7 @@ VR4300SLTIU(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   int64_t imm = (int16_t) rfexLatch->iw;
 
   exdcLatch->result.data = ((uint64_t) rs < (uint64_t) imm) ? 1 : 0;
@@ -1498,7 +1581,7 @@ VR4300SLTU(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = (rs < rt) ? 1 : 0;
   exdcLatch->result.dest = dest;
@@ -1512,8 +1595,8 @@ VR4300SRA(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = rfexLatch->iw >> 6 & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa;
+  unsigned dest = rfexLatch->operands.rd;
   int32_t result = (int32_t) rt >> sa;
 
   exdcLatch->result.data = (int64_t) result;
@@ -1529,7 +1612,7 @@ VR4300SRAV(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
   unsigned sa = rs & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   int32_t result = (int32_t) rt >> sa;
 
   exdcLatch->result.data = (int64_t) result;
@@ -1544,8 +1627,8 @@ VR4300SRL(struct VR4300 *vr4300, uint64_t unused(rs), uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned sa = rfexLatch->iw >> 6 & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned sa = rfexLatch->operands.sa;
+  unsigned dest = rfexLatch->operands.rd;
   int32_t result = (uint32_t) rt >> sa;
 
   exdcLatch->result.data = (int64_t) result;
@@ -1561,7 +1644,7 @@ VR4300SRLV(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
   unsigned sa = rs & 0x1F;
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
   int32_t result = (uint32_t) rt >> sa;
 
   exdcLatch->result.data = (int64_t) result;
@@ -1633,8 +1716,9 @@ VR4300SWR(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
  *  Instruction: SYNC (Synchronize)
  * ========================================================================= */
 void
-VR4300SYNC(struct VR4300 *unused(vr4300),
+VR4300SYNC(struct VR4300 *vr4300,
   uint64_t unused(rs), uint64_t unused(rt)) {
+  VR4300DrainWriteBuffer(&vr4300->pageTable);
 }
 
 /* ============================================================================
@@ -1762,7 +1846,7 @@ VR4300XOR(struct VR4300 *vr4300, uint64_t rs, uint64_t rt) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RD(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rd;
 
   exdcLatch->result.data = rs ^ rt;
   exdcLatch->result.dest = dest;
@@ -1776,7 +1860,7 @@ VR4300XORI(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
 
-  unsigned dest = GET_RT(rfexLatch->iw);
+  unsigned dest = rfexLatch->operands.rt;
   uint16_t imm = rfexLatch->iw;
 
   exdcLatch->result.data = rs ^ imm;
@@ -1789,24 +1873,10 @@ VR4300XORI(struct VR4300 *vr4300, uint64_t rs, uint64_t unused(rt)) {
 void
 VR4300EXStage(struct VR4300 *vr4300) {
   const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
-  const struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
   struct VR4300EXDCLatch *exdcLatch = &vr4300->pipeline.exdcLatch;
-  uint64_t rs, rt, temp = vr4300->regs[dcwbLatch->result.dest];
-  unsigned rsForwardingRegister = GET_RS(rfexLatch->iw);
-  unsigned rtForwardingRegister = GET_RT(rfexLatch->iw);
-
-  /* Always invalidate results. */
-  exdcLatch->result.dest = 0;
+  uint64_t rs, rt;
 
-  /* Forward results from DC/WB into the register file (RF). */
-  /* Copy/restore value to prevent the need for branches. */
-  vr4300->regs[dcwbLatch->result.dest] = dcwbLatch->result.data;
-  vr4300->regs[VR4300_REGISTER_ZERO] = 0;
-
-  rs = vr4300->regs[rsForwardingRegister];
-  rt = vr4300->regs[rtForwardingRegister];
-
-  vr4300->regs[dcwbLatch->result.dest] = temp;
+  VR4300ForwardOperands(vr4300, &rs, &rt);
 
 #ifndef NDEBUG
   VR4300OpcodeCounts[rfexLatch->opcode.id]++;
@@ -1814,6 +1884,7 @@ VR4300EXStage(struct VR4300 *vr4300) {
 
   /* Invoke the appropriate functional unit. */
   VR4300FunctionTable[rfexLatch->opcode.id](vr4300, rs, rt);
+
   exdcLatch->result.flags = rfexLatch->opcode.flags;
 }
 
@@ -15,5 +15,29 @@
 
 void VR4300EXStage(struct VR4300 *);
 
+/* ============================================================================
+ *  VR4300ForwardOperands: Reads the operands of the instruction in RF/EX,
+ *  forwarding any result that is still in DC/WB, and clears the EX result.
+ * ========================================================================= */
+static inline void
+VR4300ForwardOperands(struct VR4300 *vr4300, uint64_t *rs, uint64_t *rt) {
+  const struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
+  const struct VR4300DCWBLatch *dcwbLatch = &vr4300->pipeline.dcwbLatch;
+  uint64_t temp = vr4300->regs[dcwbLatch->result.dest];
+
+  /* Always invalidate results. */
+  vr4300->pipeline.exdcLatch.result.dest = 0;
+
+  /* Forward results from DC/WB into the register file (RF). */
+  /* Copy/restore value to prevent the need for branches. */
+  vr4300->regs[dcwbLatch->result.dest] = dcwbLatch->result.data;
+  vr4300->regs[VR4300_REGISTER_ZERO] = 0;
+
+  *rs = vr4300->regs[rfexLatch->operands.rs];
+  *rt = vr4300->regs[rfexLatch->operands.rt];
+
+  vr4300->regs[dcwbLatch->result.dest] = temp;
+}
+
 #endif
 
@@ -41,5 +41,14 @@ MemoryFunction BusWrite(const struct BusController *bus,
 /* This "old" memory read function is reserved for IW reads. */
 uint32_t BusReadWord(const struct BusController *, uint32_t);
 
+/* Optional: move a whole cache line of host-order words in one call. */
+/* Return 0 if handled; buses without these get one word at a time. */
+#ifdef __GNUC__
+int BusReadBlock(const struct BusController *, uint32_t, void *, size_t)
+  __attribute__((weak));
+int BusWriteBlock(const struct BusController *, uint32_t, const void *,
+  size_t) __attribute__((weak));
+#endif
+
 #endif
 
@@ -0,0 +1,375 @@
+/* ============================================================================
+ *  Fastmem.c: Host-MMU backed window onto the physical address space.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "Common.h"
+#include "CPU.h"
+#include "Fastmem.h"
+#include "PageTable.h"
+#include "WriteBuffer.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+#ifdef USE_FASTMEM
+#include <signal.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/* The window covers all of the 32-bit physical address space. */
+#define VR4300_FASTMEM_WINDOW_SIZE (1ULL << 32)
+
+/* ============================================================================
+ *  Accessors. Each one is a single access that may fault, bracketed by a
+ *  symbol at the access and one past it. When an access faults, the signal
+ *  handler does the access through the bus and resumes past it, leaving
+ *  the result where the access itself would have (rax for loads).
+ * ========================================================================= */
+#define FASTMEM_ACCESSOR(name, before, access, after) \
+  ".globl " #name "\n.hidden " #name "\n.type " #name ", @function\n" \
+  #name ":\n" before \
+  ".globl " #name "Fault\n.hidden " #name "Fault\n" #name "Fault:\n" access \
+  ".globl " #name "Resume\n.hidden " #name "Resume\n" #name "Resume:\n" \
+  after "ret\n.size " #name ", .-" #name "\n"
+
+__asm__(
+  ".text\n"
+  FASTMEM_ACCESSOR(VR4300FastmemLoad8, "", "movzbl (%rdi), %eax\n", "")
+  FASTMEM_ACCESSOR(VR4300FastmemLoad16, "", "movzwl (%rdi), %eax\n",
+    "rolw $8, %ax\n")
+  FASTMEM_ACCESSOR(VR4300FastmemLoad32, "", "movl (%rdi), %eax\n",
+    "bswapl %eax\n")
+  FASTMEM_ACCESSOR(VR4300FastmemLoad64, "", "movq (%rdi), %rax\n",
+    "bswapq %rax\n")
+  FASTMEM_ACCESSOR(VR4300FastmemStore8, "", "movb %sil, (%rdi)\n", "")
+  FASTMEM_ACCESSOR(VR4300FastmemStore16, "rolw $8, %si\n",
+    "movw %si, (%rdi)\n", "")
+  FASTMEM_ACCESSOR(VR4300FastmemStore32, "bswapl %esi\n",
+    "movl %esi, (%rdi)\n", "")
+  FASTMEM_ACCESSOR(VR4300FastmemStore64, "bswapq %rsi\n",
+    "movq %rsi, (%rdi)\n", "")
+);
+
+#undef FASTMEM_ACCESSOR
+
+/* Every accessor, with what the bus needs to know to stand in for it. */
+#define FASTMEM_ACCESSORS \
+  X(Load8, BUS_TYPE_BYTE, false) X(Load16, BUS_TYPE_HWORD, false) \
+  X(Load32, BUS_TYPE_WORD, false) X(Load64, BUS_TYPE_DWORD, false) \
+  X(Store8, BUS_TYPE_BYTE, true) X(Store16, BUS_TYPE_HWORD, true) \
+  X(Store32, BUS_TYPE_WORD, true) X(Store64, BUS_TYPE_DWORD, true)
+
+#define X(name, type, store) \
+  extern const char VR4300Fastmem##name##Fault[]; \
+  extern const char VR4300Fastmem##name##Resume[];
+FASTMEM_ACCESSORS
+#undef X
+
+struct FastmemAccess {
+  const char *fault;
+  const char *resume;
+
+  unsigned type;
+  bool store;
+};
+
+static const struct FastmemAccess FastmemAccesses[] = {
+#define X(name, type, store) \
+  {VR4300Fastmem##name##Fault, VR4300Fastmem##name##Resume, type, store},
+FASTMEM_ACCESSORS
+#undef X
+};
+
+#undef FASTMEM_ACCESSORS
+
+union FastmemContents {
+  uint8_t byte;
+  uint16_t hword;
+  uint32_t word;
+  uint64_t dword;
+};
+
+/* Most instances that can have a window reserved at once. */
+#define VR4300_FASTMEM_MAX_WINDOWS 16
+
+/* Whose window is whose; faults are routed by address. The SIGSEGV */
+/* handler is ours for as long as any window is reserved. */
+static const struct VR4300PageTable *WindowOwners[VR4300_FASTMEM_MAX_WINDOWS];
+static unsigned NumWindows;
+static struct sigaction PreviousAction;
+
+static const struct VR4300PageTable *FindWindowOwner(const uint8_t *);
+static void HandleFault(int, siginfo_t *, void *);
+static uint64_t SwapContents(unsigned, uint64_t);
+
+/* ============================================================================
+ *  FindWindowOwner: Returns the page table of the instance whose window
+ *  holds a host address, or NULL if it's in none of them.
+ * ========================================================================= */
+static const struct VR4300PageTable *
+FindWindowOwner(const uint8_t *host) {
+  unsigned i;
+
+  for (i = 0; i < VR4300_FASTMEM_MAX_WINDOWS; i++) {
+    const struct VR4300PageTable *table = WindowOwners[i];
+
+    if (table != NULL && host >= table->fastmem &&
+      (uint64_t) (host - table->fastmem) < VR4300_FASTMEM_WINDOW_SIZE)
+      return table;
+  }
+
+  return NULL;
+}
+
+/* ============================================================================
+ *  HandleFault: Routes faulting accessor loads and stores to the bus.
+ *  Anything else is handed to whoever had the signal before us.
+ * ========================================================================= */
+static void
+HandleFault(int signal, siginfo_t *info, void *context) {
+  const struct FastmemAccess *access = NULL;
+  const struct VR4300PageTable *table;
+  ucontext_t *ucontext = (ucontext_t*) context;
+  greg_t *regs = ucontext->uc_mcontext.gregs;
+  const uint8_t *host = (const uint8_t*) info->si_addr;
+  union FastmemContents contents;
+  MemoryFunction function;
+  uint32_t address;
+  void *opaque;
+  unsigned i;
+
+  for (i = 0; i < sizeof(FastmemAccesses) / sizeof(*FastmemAccesses); i++) {
+    if ((const char*) regs[REG_RIP] == FastmemAccesses[i].fault) {
+      access = &FastmemAccesses[i];
+      break;
+    }
+  }
+
+  if (access == NULL || (table = FindWindowOwner(host)) == NULL) {
+    if (PreviousAction.sa_flags & SA_SIGINFO)
+      PreviousAction.sa_sigaction(signal, info, context);
+
+    else if (PreviousAction.sa_handler != SIG_DFL &&
+      PreviousAction.sa_handler != SIG_IGN)
+      PreviousAction.sa_handler(signal);
+
+    /* Retry the access with the old disposition in place. */
+    else
+      sigaction(SIGSEGV, &PreviousAction, NULL);
+
+    return;
+  }
+
+  address = host - table->fastmem;
+  contents.dword = 0;
+
+  /* MMIO (e.g., a DMA start) must see any buffered partial store. */
+  if (table->writeBuffer->count)
+    VR4300DrainWriteBuffer(table);
+
+  if (access->store) {
+    uint64_t data = SwapContents(access->type, regs[REG_RSI]);
+
+    switch (access->type) {
+      case BUS_TYPE_BYTE: contents.byte = data; break;
+      case BUS_TYPE_HWORD: contents.hword = data; break;
+      case BUS_TYPE_WORD: contents.word = data; break;
+      default: contents.dword = data; break;
+    }
+
+    if ((function = VR4300PageWrite(
+      table, access->type, address, &opaque)) != NULL)
+      function(opaque, address, &contents);
+  }
+
+  else {
+    uint64_t data;
+
+    if ((function = VR4300PageRead(
+      table, access->type, address, &opaque)) != NULL)
+      function(opaque, address, &contents);
+
+    switch (access->type) {
+      case BUS_TYPE_BYTE: data = contents.byte; break;
+      case BUS_TYPE_HWORD: data = contents.hword; break;
+      case BUS_TYPE_WORD: data = contents.word; break;
+      default: data = contents.dword; break;
+    }
+
+    /* The accessor swaps after loading; hand it memory order. */
+    regs[REG_RAX] = SwapContents(access->type, data);
+  }
+
+  regs[REG_RIP] = (greg_t) access->resume;
+}
+
+/* ============================================================================
+ *  SwapContents: Swaps data of the given width between memory and native
+ *  byte order (the upper bits of the result are zero).
+ * ========================================================================= */
+static uint64_t
+SwapContents(unsigned type, uint64_t data) {
+  switch (type) {
+    case BUS_TYPE_BYTE: return (uint8_t) data;
+    case BUS_TYPE_HWORD: return ByteOrderSwap16(data);
+    case BUS_TYPE_WORD: return ByteOrderSwap32(data);
+    default: return ByteOrderSwap64(data);
+  }
+}
+
+/* ============================================================================
+ *  VR4300DestroyFastmem: Releases the window and any views into it.
+ * ========================================================================= */
+void
+VR4300DestroyFastmem(struct VR4300 *vr4300) {
+  struct VR4300Fastmem *fastmem = &vr4300->fastmem;
+  unsigned i;
+
+  if (fastmem->window == NULL)
+    return;
+
+  for (i = 0; i < VR4300_FASTMEM_MAX_WINDOWS; i++) {
+    if (WindowOwners[i] == &vr4300->pageTable)
+      WindowOwners[i] = NULL;
+  }
+
+  /* Hand SIGSEGV back once the last window is gone. */
+  if (--NumWindows == 0)
+    sigaction(SIGSEGV, &PreviousAction, NULL);
+
+  for (i = 0; i < fastmem->numViews; i++)
+    munmap(fastmem->views[i].view, fastmem->views[i].size);
+
+  munmap(fastmem->window, VR4300_FASTMEM_WINDOW_SIZE);
+  vr4300->pageTable.fastmem = NULL;
+  VR4300InitFastmem(fastmem);
+}
+
+/* ============================================================================
+ *  VR4300EnableFastmem: Reserves the window, and takes over SIGSEGV if no
+ *  other instance has already. Everything starts out inaccessible, and so
+ *  goes through the bus. Returns false if no more windows can be had.
+ * ========================================================================= */
+bool
+VR4300EnableFastmem(struct VR4300 *vr4300) {
+  struct VR4300Fastmem *fastmem = &vr4300->fastmem;
+  struct sigaction action;
+  unsigned slot;
+  void *window;
+
+  if (fastmem->window != NULL)
+    return true;
+
+  for (slot = 0; slot < VR4300_FASTMEM_MAX_WINDOWS; slot++) {
+    if (WindowOwners[slot] == NULL)
+      break;
+  }
+
+  if (slot == VR4300_FASTMEM_MAX_WINDOWS)
+    return false;
+
+  if ((window = mmap(NULL, VR4300_FASTMEM_WINDOW_SIZE, PROT_NONE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)) == MAP_FAILED)
+    return false;
+
+  if (NumWindows == 0) {
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = HandleFault;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGSEGV, &action, &PreviousAction)) {
+      munmap(window, VR4300_FASTMEM_WINDOW_SIZE);
+      return false;
+    }
+  }
+
+  fastmem->window = (uint8_t*) window;
+  vr4300->pageTable.fastmem = fastmem->window;
+  WindowOwners[slot] = &vr4300->pageTable;
+  NumWindows++;
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300MapFastmemPages: Backs a range of pages with memory that shows up
+ *  in the window directly, and returns a read-write view of it for the bus
+ *  to keep its contents in (e.g., RDRAM or cartridge ROM). The pages are
+ *  registered in the page table, too (which discards anything decoded from
+ *  the range before). Returns NULL if fastmem is off.
+ * ========================================================================= */
+uint8_t *
+VR4300MapFastmemPages(struct VR4300 *vr4300,
+  uint32_t base, uint32_t size, bool writable) {
+  struct VR4300Fastmem *fastmem = &vr4300->fastmem;
+  int protection = PROT_READ | (writable ? PROT_WRITE : 0);
+  void *view, *mapping;
+  int fd;
+
+  if (fastmem->window == NULL || fastmem->numViews == VR4300_FASTMEM_MAX_VIEWS)
+    return NULL;
+
+  if ((fd = memfd_create("vr4300-fastmem", 0)) < 0)
+    return NULL;
+
+  if (ftruncate(fd, size) || (view = mmap(NULL, size,
+    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+
+  mapping = mmap(fastmem->window + base, size,
+    protection, MAP_SHARED | MAP_FIXED, fd, 0);
+
+  close(fd);
+
+  if (mapping == MAP_FAILED) {
+    munmap(view, size);
+    return NULL;
+  }
+
+  fastmem->views[fastmem->numViews].view = (uint8_t*) view;
+  fastmem->views[fastmem->numViews++].size = size;
+
+  VR4300MapHostPages(vr4300, base, size, (uint8_t*) view, writable);
+  return (uint8_t*) view;
+}
+
+#else
+void
+VR4300DestroyFastmem(struct VR4300 *unused(vr4300)) {
+}
+
+bool
+VR4300EnableFastmem(struct VR4300 *unused(vr4300)) {
+  return false;
+}
+
+uint8_t *
+VR4300MapFastmemPages(struct VR4300 *unused(vr4300),
+  uint32_t unused(base), uint32_t unused(size), bool unused(writable)) {
+  return NULL;
+}
+#endif
+
+/* ============================================================================
+ *  VR4300InitFastmem: Initializes fastmem. It starts out disabled.
+ * ========================================================================= */
+void
+VR4300InitFastmem(struct VR4300Fastmem *fastmem) {
+  memset(fastmem, 0, sizeof(*fastmem));
+}
+
@@ -0,0 +1,104 @@
+/* ============================================================================
+ *  Fastmem.h: Host-MMU backed window onto the physical address space.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__FASTMEM_H__
+#define __VR4300__FASTMEM_H__
+#include "Common.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+/* Fault handling decodes x86-64 Linux signal contexts. */
+#if defined(USE_FASTMEM) && \
+  (!defined(__x86_64__) || !defined(__linux__))
+#undef USE_FASTMEM
+#endif
+
+/* Most distinct ranges (RDRAM, ROM, ...) that can be mapped in. */
+#define VR4300_FASTMEM_MAX_VIEWS 8
+
+struct VR4300FastmemView {
+  uint8_t *view;
+  uint32_t size;
+};
+
+struct VR4300Fastmem {
+  uint8_t *window;
+
+  struct VR4300FastmemView views[VR4300_FASTMEM_MAX_VIEWS];
+  unsigned numViews;
+};
+
+struct VR4300;
+
+/* Each instance reserves a window of its own, and faults in it are sent */
+/* to that instance. Enabling and destroying fastmem must not race with */
+/* other instances doing either, or with their accesses. */
+
+/* Accesses that no view backs (MMIO, unmapped pages) fault, and are */
+/* finished from within the SIGSEGV handler, on the faulting thread. So */
+/* BusRead/BusWrite and any device handlers (VR4300MapDevicePages) may */
+/* run in signal context: they must return normally (no longjmp or C++ */
+/* exceptions out of them), and mustn't take locks that code around the */
+/* access might already hold. */
+
+void VR4300DestroyFastmem(struct VR4300 *);
+bool VR4300EnableFastmem(struct VR4300 *);
+void VR4300InitFastmem(struct VR4300Fastmem *);
+uint8_t *VR4300MapFastmemPages(struct VR4300 *, uint32_t, uint32_t, bool);
+
+/* Accessors; host pointers are into the window. Values are native. */
+#ifdef USE_FASTMEM
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t VR4300FastmemLoad8(const uint8_t *);
+uint16_t VR4300FastmemLoad16(const uint8_t *);
+uint32_t VR4300FastmemLoad32(const uint8_t *);
+uint64_t VR4300FastmemLoad64(const uint8_t *);
+void VR4300FastmemStore8(uint8_t *, uint8_t);
+void VR4300FastmemStore16(uint8_t *, uint16_t);
+void VR4300FastmemStore32(uint8_t *, uint32_t);
+void VR4300FastmemStore64(uint8_t *, uint64_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+#define VR4300_FASTMEM_ACCESSORS(bits, swap) \
+  static inline uint##bits##_t \
+  VR4300FastmemLoad##bits(const uint8_t *host) { \
+    uint##bits##_t value; \
+    memcpy(&value, host, sizeof(value)); \
+    return swap(value); \
+  } \
+  \
+  static inline void \
+  VR4300FastmemStore##bits(uint8_t *host, uint##bits##_t value) { \
+    value = swap(value); \
+    memcpy(host, &value, sizeof(value)); \
+  }
+
+#define VR4300_FASTMEM_NO_SWAP(value) (value)
+VR4300_FASTMEM_ACCESSORS(8, VR4300_FASTMEM_NO_SWAP)
+VR4300_FASTMEM_ACCESSORS(16, ByteOrderSwap16)
+VR4300_FASTMEM_ACCESSORS(32, ByteOrderSwap32)
+VR4300_FASTMEM_ACCESSORS(64, ByteOrderSwap64)
+#undef VR4300_FASTMEM_NO_SWAP
+#undef VR4300_FASTMEM_ACCESSORS
+#endif
+
+#endif
+
@@ -13,6 +13,7 @@
 #include "CPU.h"
 #include "Fault.h"
 #include "ICache.h"
+#include "IdleLoop.h"
 #include "Pipeline.h"
 
 #ifdef __cplusplus
@@ -72,6 +73,7 @@ CommonExceptionHandler(struct VR4300CP0 *cp0, uint64_t *pc,
   /* Disable interrupts. */
   /* Switch to kernel mode. */
   cp0->interruptRaiseMask = 0;
+  cp0->interruptPending = false;
   cp0->regs.status.exl = 1;
 
   /* Jump to the exception vector. */
@@ -178,7 +180,7 @@ void
 VR4300FaultCOP(struct VR4300 *vr4300) {
   /* TODO: Selectively handle ICache/DCache */
   uint32_t address = vr4300->pipeline.faultManager.ilData; /* TODO: vaddr */
-  VR4300ICacheFill(&vr4300->icache, vr4300->bus, address, address);
+  VR4300ICacheFill(&vr4300->icache, &vr4300->pageTable, address, address);
 
   /* Restore latch contents that may have been lost. */
   memcpy(&vr4300->pipeline.icrfLatch, &vr4300->pipeline.faultManager.
@@ -207,6 +209,8 @@ VR4300FaultCPU(struct VR4300 *vr4300) {
   cp0->regs.cause.ce = manager->excpCauseData;
   CommonExceptionHandler(cp0, &pipeline->icrfLatch.pc,
     manager->faultingPC, 11, manager->nextOpcodeFlags);
+  VR4300UpdateRegionMap(&vr4300->regionMap, vr4300);
+  VR4300FlushMicroTLBs(&vr4300->tlb);
 }
 
 /* ============================================================================
@@ -281,7 +285,7 @@ VR4300FaultICB(struct VR4300 *vr4300) {
   uint64_t vaddr = vr4300->pipeline.faultManager.savedIcrfLatch.address;
   uint32_t paddr = vr4300->pipeline.faultManager.ilData;
 
-  VR4300ICacheFill(&vr4300->icache, vr4300->bus, vaddr, paddr);
+  VR4300ICacheFill(&vr4300->icache, &vr4300->pageTable, vaddr, paddr);
 
   /* Restore latch contents that may have been lost. */
   memcpy(&vr4300->pipeline.icrfLatch, &vr4300->pipeline.faultManager.
@@ -299,10 +303,13 @@ VR4300FaultINTR(struct VR4300 *vr4300) {
 
   debug("Handing fault: INTR.");
   vr4300->cp0.interruptRaiseMask = 0;
+  vr4300->cp0.interruptPending = false;
 
   cp0->regs.cause.ce = manager->excpCauseData;
   CommonExceptionHandler(cp0, &pipeline->icrfLatch.pc,
     manager->faultingPC, 0, manager->nextOpcodeFlags);
+  VR4300UpdateRegionMap(&vr4300->regionMap, vr4300);
+  VR4300FlushMicroTLBs(&vr4300->tlb);
 }
 
 /* ============================================================================
@@ -386,6 +393,9 @@ VR4300FaultRST(struct VR4300 *vr4300) {
     cp0->regs.config.ec = 0;
   }
 
+  VR4300UpdateRegionMap(&vr4300->regionMap, vr4300);
+  VR4300FlushMicroTLBs(&vr4300->tlb);
+
   /* Change the PC to the reset exception vector. */
   pipeline->icrfLatch.pc = VR4300_RESET_VECTOR - 4;
 }
@@ -452,6 +462,11 @@ HandleExceptions(struct VR4300 *vr4300) {
 
   /* Resolve the exception appropriately. */
   FaultHandlerTable[manager->excp](vr4300);
+  VR4300IdleLoopSideEffect(vr4300);
+
+#ifdef DO_FASTFORWARD
+  vr4300->pipeline.idle.active = false;
+#endif
 
   /* Reset the pipeline (to effectively flush it). */
   manager->excpIndex = VR4300_PCU_NORMAL;
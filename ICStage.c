@@ -23,15 +23,25 @@
 /* ============================================================================
  *  VR4300ICStage: Fetches an instruction from ICache.
  * ========================================================================= */
-void
+VR4300_MODE_TEMPLATE void
 VR4300ICStage(struct VR4300 *vr4300) {
   struct VR4300ICRFLatch *icrfLatch = &vr4300->pipeline.icrfLatch;
   const struct RegionInfo *region = icrfLatch->region;
   uint64_t pc = icrfLatch->pc;
 
   /* TODO: Giant hack: bypass the ICache/ITLB/TLB for now. */
-  if (unlikely((pc - region->start) >= region->length)) {
-    if ((region = GetRegionInfo(vr4300, pc)) == NULL) {
+  /* 32-bit modes: the table has the region; no range checks. */
+  if (VR4300_THIS_MODE != VR4300_MODE_64BIT) {
+    if (unlikely((region = VR4300LookupRegion32(vr4300, pc)) == NULL)) {
+      debug("Unimplemented fault: VR4300_FAULT_IADE.");
+      return;
+    }
+
+    icrfLatch->region = region;
+  }
+
+  else if (unlikely((pc - region->start) >= region->length)) {
+    if ((region = VR4300LookupRegion(vr4300, pc)) == NULL) {
       debug("Unimplemented fault: VR4300_FAULT_IADE.");
       return;
     }
@@ -42,3 +52,17 @@ VR4300ICStage(struct VR4300 *vr4300) {
   icrfLatch->address = pc - region->offset;
 }
 
+/* ============================================================================
+ *  Exported stage; the instantiations for each addressing mode.
+ * ========================================================================= */
+#ifdef __cplusplus
+template void VR4300ICStage<VR4300_MODE_KERNEL32>(struct VR4300 *);
+template void VR4300ICStage<VR4300_MODE_USER32>(struct VR4300 *);
+template void VR4300ICStage<VR4300_MODE_64BIT>(struct VR4300 *);
+
+void
+VR4300ICStage(struct VR4300 *vr4300) {
+  VR4300ICStage<VR4300_MODE_64BIT>(vr4300);
+}
+#endif
+
@@ -25,23 +25,63 @@
  *  Fills an instruction cache line, sets the tags, etc.
  * ========================================================================= */
 void VR4300ICacheFill(struct VR4300ICache *icache,
-  struct BusController *bus, uint64_t vaddr, uint32_t paddr) {
+  const struct VR4300PageTable *pages, uint64_t vaddr, uint32_t paddr) {
   struct VR4300ICacheLineData *data;
+  uint32_t words[8];
   unsigned lineIdx = vaddr >> 5 & 0x1FF;
-  unsigned tag = paddr >> 12;
   unsigned i;
 
   /* Mark the line as valid. */
   data = icache->lines[lineIdx].data;
-  icache->lines[lineIdx].tag = tag;
-  icache->valid[lineIdx] = true;
+  icache->tags[lineIdx] = paddr >> 12 | VR4300_ICACHE_VALID;
   paddr &= 0xFFFFFFE0;
 
   /* And fill it entirely. */
-  for (i = 0 ; i < 8; i++, paddr += 4, data++) {
-    uint32_t word = BusReadWord(bus, paddr);
+  VR4300ReadLineWords(pages, paddr, words, sizeof(words));
+
+  for (i = 0 ; i < 8; i++, data++) {
+    uint32_t word = words[i];
     data->opcode = *VR4300DecodeInstruction(word);
     data->word = word;
+
+    VR4300DecodeOperands(word, &data->operands);
+  }
+}
+
+/* ============================================================================
+ *  Invalidates every line.
+ * ========================================================================= */
+void VR4300ICacheInvalidateAll(struct VR4300ICache *icache) {
+  memset(icache->tags, 0, sizeof(icache->tags));
+}
+
+/* ============================================================================
+ *  Invalidates any line that holds part of a physical address range. Only
+ *  bits 12 and 13 of the (virtual) index can differ from the physical
+ *  address, so a line can only be in one of four slots; past a page, it's
+ *  cheaper to just look at all of them.
+ * ========================================================================= */
+void VR4300ICacheInvalidateRange(struct VR4300ICache *icache,
+  uint32_t paddr, uint32_t length) {
+  uint32_t address, end = paddr + length;
+  unsigned i;
+
+  if (length >= 4096) {
+    for (i = 0; i < VR4300_ICACHE_LINES; i++) {
+      address = icache->tags[i] << 12 | (i << 5 & 0xFE0);
+
+      if (address + 32 > paddr && address < end)
+        icache->tags[i] &= ~VR4300_ICACHE_VALID;
+    }
+
+    return;
+  }
+
+  for (address = paddr & ~0x1FU; address < end; address += 32) {
+    for (i = address >> 5 & 0x7F; i < VR4300_ICACHE_LINES; i += 128) {
+      if (icache->tags[i] == (address >> 12 | VR4300_ICACHE_VALID))
+        icache->tags[i] &= ~VR4300_ICACHE_VALID;
+    }
   }
 }
 
@@ -53,11 +93,10 @@ const struct VR4300ICacheLineData* VR4300ICacheProbe(
   const struct VR4300ICacheLineData *cacheData;
   unsigned lineIdx = vaddr >> 5 & 0x1FF;
   unsigned offset = paddr >> 2 & 0x7;
-  unsigned tag = paddr >> 12;
 
   /* Virtually indexed, physically tagged. */
   cacheData = &icache->lines[lineIdx].data[offset];
-  if (!icache->valid[lineIdx] || icache->lines[lineIdx].tag != tag)
+  if (icache->tags[lineIdx] != (paddr >> 12 | VR4300_ICACHE_VALID))
     return NULL;
 
   return cacheData;
@@ -67,6 +106,6 @@ const struct VR4300ICacheLineData* VR4300ICacheProbe(
  *  Initializes the instruction cache, invalidating all lines.
  * ========================================================================= */
 void VR4300InitICache(struct VR4300ICache *icache) {
-  memset(icache->valid, 0, sizeof(icache->valid));
+  VR4300ICacheInvalidateAll(icache);
 }
 
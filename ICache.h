@@ -13,26 +13,37 @@
 #include "Common.h"
 #include "Decoder.h"
 #include "Externs.h"
+#include "PageTable.h"
 
 struct VR4300ICacheLineData {
   struct VR4300Opcode opcode;
-  uint32_t word, padding;
+  uint32_t word;
+
+  /* Must line up with the RF/EX latch; see ProduceLatchOutputs. */
+  struct VR4300Operands operands;
 };
 
+#define VR4300_ICACHE_LINES 512
+
+/* Tags are the physical page number with the valid bit folded in. */
+#define VR4300_ICACHE_VALID 0x80000000U
+
 struct VR4300ICacheLine {
   struct VR4300ICacheLineData data[8];
-  uint32_t tag;
 };
 
+/* Aligned, so that no instruction straddles a host cache line. */
 struct VR4300ICache {
-  struct VR4300ICacheLine lines[512];
-  bool valid[512];
+  struct VR4300ICacheLine lines[VR4300_ICACHE_LINES] align(16);
+  uint32_t tags[VR4300_ICACHE_LINES];
 };
 
 void VR4300InitICache(struct VR4300ICache *);
+void VR4300ICacheInvalidateAll(struct VR4300ICache *);
 
 void VR4300ICacheFill(struct VR4300ICache *,
-  struct BusController *, uint64_t, uint32_t);
+  const struct VR4300PageTable *, uint64_t, uint32_t);
+void VR4300ICacheInvalidateRange(struct VR4300ICache *, uint32_t, uint32_t);
 const struct VR4300ICacheLineData* VR4300ICacheProbe(
   const struct VR4300ICache *, uint64_t, uint32_t);
 
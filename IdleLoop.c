@@ -0,0 +1,102 @@
+/* ============================================================================
+ *  IdleLoop.c: Idle loop detection.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CPU.h"
+#include "Fault.h"
+#include "IdleLoop.h"
+#include "Pipeline.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+#ifdef DO_FASTFORWARD
+/* ============================================================================
+ *  VR4300DetectIdleLoop: Called whenever a short backward branch is taken.
+ *
+ *  If an iteration of the loop completes without any side effects (stores,
+ *  MMIO accesses, reads of Count, CP0 writes, exceptions, ...) and leaves
+ *  the machine in the same state as the previous one, the loop will spin
+ *  until an interrupt arrives or the embedder touches memory. In that case,
+ *  fast-forward the pipeline; VR4300Run will skip to the next event.
+ * ========================================================================= */
+void
+VR4300DetectIdleLoop(struct VR4300 *vr4300) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  struct VR4300IdleLoop *idle = &pipeline->idle;
+  uint64_t pc = pipeline->rfexLatch.pc;
+
+  /* Only VR4300Run bounds the time we may skip. */
+  if (!pipeline->runUntil)
+    return;
+
+  if (idle->pc != pc || idle->dirty) {
+    if (idle->pc != pc)
+      idle->backoff = 0;
+
+    idle->pc = pc;
+    idle->armed = false;
+    idle->dirty = false;
+    return;
+  }
+
+  if (idle->backoff > 0) {
+    idle->backoff--;
+    return;
+  }
+
+  if (idle->armed &&
+    !memcmp(idle->regs, vr4300->regs, sizeof(idle->regs)) &&
+    !memcmp(&idle->result, &pipeline->dcwbLatch.result,
+      sizeof(idle->result)) &&
+    !memcmp(&idle->cp1, &vr4300->cp1, sizeof(idle->cp1))) {
+
+    if (pipeline->faultManager.excpIndex == VR4300_PCU_NORMAL) {
+      pipeline->faultManager.excpIndex = VR4300_PCU_FASTFORWARD;
+      pipeline->faultManager.faulting = 1;
+      idle->active = true;
+    }
+
+    return;
+  }
+
+  /* The loop is making progress; don't snapshot every iteration. */
+  if (idle->armed)
+    idle->backoff = VR4300_IDLE_LOOP_BACKOFF;
+
+  memcpy(idle->regs, vr4300->regs, sizeof(idle->regs));
+  memcpy(&idle->result, &pipeline->dcwbLatch.result, sizeof(idle->result));
+  memcpy(&idle->cp1, &vr4300->cp1, sizeof(idle->cp1));
+  idle->armed = true;
+}
+
+/* ============================================================================
+ *  VR4300LeaveIdleLoop: Resumes a loop that was fast-forwarded by the
+ *  detector. The embedder may have changed memory that it polls, so the
+ *  loop has to be re-evaluated when VR4300Run hands control back.
+ * ========================================================================= */
+void
+VR4300LeaveIdleLoop(struct VR4300 *vr4300) {
+  struct VR4300FaultManager *manager = &vr4300->pipeline.faultManager;
+  struct VR4300IdleLoop *idle = &vr4300->pipeline.idle;
+
+  if (idle->active && manager->excpIndex == VR4300_PCU_FASTFORWARD) {
+    manager->excpIndex = VR4300_PCU_NORMAL;
+    manager->faulting = manager->ilIndex != VR4300_PCU_NORMAL;
+  }
+
+  idle->active = false;
+  idle->armed = false;
+}
+#endif
+
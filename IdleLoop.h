@@ -0,0 +1,51 @@
+/* ============================================================================
+ *  IdleLoop.h: Idle loop detection.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__IDLELOOP_H__
+#define __VR4300__IDLELOOP_H__
+#include "Common.h"
+#include "CP1.h"
+#include "Latches.h"
+
+/* Largest backward branch considered for a loop. */
+#define VR4300_IDLE_LOOP_MAX_BYTES 128
+
+/* Iterations to wait before re-checking a loop that made progress. */
+#define VR4300_IDLE_LOOP_BACKOFF 64
+
+#ifdef DO_FASTFORWARD
+struct VR4300IdleLoop {
+  uint64_t pc;
+  unsigned backoff;
+
+  bool active;
+  bool armed;
+  bool dirty;
+
+  /* Everything the next iteration depends on. */
+  uint64_t regs[32 + 2];
+  struct VR4300Result result;
+  struct VR4300CP1 cp1;
+};
+
+struct VR4300;
+
+void VR4300DetectIdleLoop(struct VR4300 *);
+void VR4300LeaveIdleLoop(struct VR4300 *);
+
+/* Stores, MMIO, CP0 writes, etc. prove that a loop isn't idle. */
+#define VR4300IdleLoopSideEffect(vr4300) \
+  ((vr4300)->pipeline.idle.dirty = true)
+#else
+#define VR4300IdleLoopSideEffect(vr4300) ((void) 0)
+#endif
+
+#endif
+
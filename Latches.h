@@ -29,7 +29,10 @@ struct VR4300ICRFLatch {
 struct VR4300RFEXLatch {
   uint64_t pc;
   struct VR4300Opcode opcode;
-  uint32_t iw, padding;
+  uint32_t iw;
+
+  /* Filled in alongside the opcode; see VR4300DecodeOperands. */
+  struct VR4300Operands operands;
 };
 
 struct VR4300EXDCLatch {
@@ -37,9 +40,12 @@ struct VR4300EXDCLatch {
   struct VR4300MemoryData memoryData;
 };
 
+/* Most recently used first; e.g., RDRAM in kseg0 and MMIO in kseg1. */
+#define VR4300_DC_REGIONS 2
+
 struct VR4300DCWBLatch {
   struct VR4300Result result;
-  const struct RegionInfo *region;
+  const struct RegionInfo *regions[VR4300_DC_REGIONS];
 };
 
 #endif
@@ -0,0 +1,92 @@
+/* ============================================================================
+ *  MicroTLB.h: Instruction and data micro-TLBs.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__MICROTLB_H__
+#define __VR4300__MICROTLB_H__
+#include "Common.h"
+
+/* A few recent translations for each stream; replaced round-robin. */
+#define VR4300_MICROTLB_ENTRIES 4
+
+/* Never a page address (the low 12 bits of those are always clear). */
+/* Flushed entries get the smallest mask, so nothing matches them. */
+#define VR4300_MICROTLB_INVALID 0x1ULL
+
+struct VR4300MicroTLBEntry {
+  uint64_t vpn;
+  uint32_t pfn;
+  uint32_t mask;
+};
+
+/* Entries are only valid for the ASID and mode they were filled */
+/* under; anything that changes either flushes the micro-TLBs. */
+struct VR4300MicroTLB {
+  struct VR4300MicroTLBEntry entries[VR4300_MICROTLB_ENTRIES];
+  unsigned next;
+
+  /* Translations served here, and ones that had to search the TLB. */
+  unsigned long long hits;
+  unsigned long long misses;
+};
+
+/* ============================================================================
+ *  VR4300FillMicroTLB: Remembers a translation, evicting the oldest one.
+ * ========================================================================= */
+static inline void
+VR4300FillMicroTLB(struct VR4300MicroTLB *utlb,
+  uint64_t vaddr, uint32_t pfn, uint32_t mask) {
+  struct VR4300MicroTLBEntry *entry = utlb->entries + utlb->next;
+
+  entry->vpn = vaddr & ~(uint64_t) mask;
+  entry->pfn = pfn;
+  entry->mask = mask;
+
+  utlb->next = (utlb->next + 1) & (VR4300_MICROTLB_ENTRIES - 1);
+}
+
+/* ============================================================================
+ *  VR4300FlushMicroTLB: Invalidates every entry; the counters are kept.
+ * ========================================================================= */
+static inline void
+VR4300FlushMicroTLB(struct VR4300MicroTLB *utlb) {
+  unsigned i;
+
+  for (i = 0; i < VR4300_MICROTLB_ENTRIES; i++) {
+    utlb->entries[i].vpn = VR4300_MICROTLB_INVALID;
+    utlb->entries[i].mask = 0xFFF;
+  }
+
+  utlb->next = 0;
+}
+
+/* ============================================================================
+ *  VR4300MicroTLBLookup: Translates a virtual address if a recent
+ *  translation covers it. Returns false (and counts nothing) otherwise.
+ * ========================================================================= */
+static inline bool
+VR4300MicroTLBLookup(struct VR4300MicroTLB *utlb,
+  uint64_t vaddr, uint32_t *paddr) {
+  unsigned i;
+
+  for (i = 0; i < VR4300_MICROTLB_ENTRIES; i++) {
+    const struct VR4300MicroTLBEntry *entry = utlb->entries + i;
+
+    if ((vaddr & ~(uint64_t) entry->mask) == entry->vpn) {
+      *paddr = entry->pfn | ((uint32_t) vaddr & entry->mask);
+      utlb->hits++;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+#endif
+
@@ -58,6 +58,12 @@ extern const char *VR4300OpcodeMnemonics[NUM_VR4300_OPCODES];
 #define FPUL VR4300_BUILD_OP(FPUL, INFO1(NONE))
 #define TLB VR4300_BUILD_OP(TLB, INFO1(NONE))
 
+/* Not actual instructions; operand-specialized forms of real ones. */
+#define B VR4300_BUILD_OP(B, INFO1(BRANCH))
+#define LI VR4300_BUILD_OP(LI, INFO1(WRITE_RT))
+#define MOVE VR4300_BUILD_OP(MOVE, INFO2(NEED_RS, WRITE_RD))
+#define NOP VR4300_BUILD_OP(NOP, INFO1(NONE))
+
 /* List of instructions; not complete/correct. */
 #define ADD VR4300_BUILD_OP(ADD_ADDU_SUB_SUBU, INFO1(NONE))
 #define ADDI VR4300_BUILD_OP(ADDI_SUBI_ADDIU_SUBIU, INFO1(NONE))
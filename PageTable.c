@@ -0,0 +1,410 @@
+/* ============================================================================
+ *  PageTable.c: Physical page dispatch table (CPU side of the bus).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CPU.h"
+#include "PageTable.h"
+
+#ifdef __cplusplus
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#else
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#ifdef USE_SSE
+#include <emmintrin.h>
+#endif
+
+/* Longest line moved at once (an ICache line). */
+#define MAX_LINE_SIZE 32
+
+static int HostReadByte(void *, uint32_t, void *);
+static int HostReadDWord(void *, uint32_t, void *);
+static int HostReadHWord(void *, uint32_t, void *);
+static int HostReadWord(void *, uint32_t, void *);
+static int HostWriteByte(void *, uint32_t, void *);
+static int HostWriteDWord(void *, uint32_t, void *);
+static int HostWriteHWord(void *, uint32_t, void *);
+static int HostWriteUnaligned(void *, uint32_t, void *);
+static int HostWriteWord(void *, uint32_t, void *);
+static void MapPages(struct VR4300PageTable *, uint32_t, uint32_t,
+  const struct VR4300PageHandlers *, void *, uint8_t *);
+static void SwapLine(void *, const void *, size_t);
+
+/* Handlers for directly-mapped memory; opaque is the page's base. */
+/* Unaligned reads are never issued, so they go to the bus as-is. */
+static const struct VR4300PageHandlers HostHandlers = {
+  {HostReadByte, HostReadHWord, HostReadWord, NULL, HostReadDWord},
+  {HostWriteByte, HostWriteHWord, HostWriteWord,
+    HostWriteUnaligned, HostWriteDWord}
+};
+
+static const struct VR4300PageHandlers ReadOnlyHostHandlers = {
+  {HostReadByte, HostReadHWord, HostReadWord, NULL, HostReadDWord},
+  {NULL, NULL, NULL, NULL, NULL}
+};
+
+/* ============================================================================
+ *  HostReadByte: Reads a byte from directly-mapped memory.
+ * ========================================================================= */
+static int
+HostReadByte(void *opaque, uint32_t address, void *contents) {
+  const uint8_t *host = (const uint8_t*) opaque;
+
+  memcpy(contents, host + (address & VR4300_PAGE_MASK), sizeof(uint8_t));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostReadDWord: Reads a doubleword from directly-mapped memory.
+ * ========================================================================= */
+static int
+HostReadDWord(void *opaque, uint32_t address, void *contents) {
+  const uint8_t *host = (const uint8_t*) opaque;
+  uint64_t dword;
+
+  memcpy(&dword, host + (address & VR4300_PAGE_MASK), sizeof(dword));
+  dword = ByteOrderSwap64(dword);
+  memcpy(contents, &dword, sizeof(dword));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostReadHWord: Reads a halfword from directly-mapped memory.
+ * ========================================================================= */
+static int
+HostReadHWord(void *opaque, uint32_t address, void *contents) {
+  const uint8_t *host = (const uint8_t*) opaque;
+  uint16_t hword;
+
+  memcpy(&hword, host + (address & VR4300_PAGE_MASK), sizeof(hword));
+  hword = ByteOrderSwap16(hword);
+  memcpy(contents, &hword, sizeof(hword));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostReadWord: Reads a word from directly-mapped memory.
+ * ========================================================================= */
+static int
+HostReadWord(void *opaque, uint32_t address, void *contents) {
+  const uint8_t *host = (const uint8_t*) opaque;
+  uint32_t word;
+
+  memcpy(&word, host + (address & VR4300_PAGE_MASK), sizeof(word));
+  word = ByteOrderSwap32(word);
+  memcpy(contents, &word, sizeof(word));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostWriteByte: Writes a byte to directly-mapped memory.
+ * ========================================================================= */
+static int
+HostWriteByte(void *opaque, uint32_t address, void *contents) {
+  uint8_t *host = (uint8_t*) opaque;
+
+  memcpy(host + (address & VR4300_PAGE_MASK), contents, sizeof(uint8_t));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostWriteDWord: Writes a doubleword to directly-mapped memory.
+ * ========================================================================= */
+static int
+HostWriteDWord(void *opaque, uint32_t address, void *contents) {
+  uint8_t *host = (uint8_t*) opaque;
+  uint64_t dword;
+
+  memcpy(&dword, contents, sizeof(dword));
+  dword = ByteOrderSwap64(dword);
+  memcpy(host + (address & VR4300_PAGE_MASK), &dword, sizeof(dword));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostWriteHWord: Writes a halfword to directly-mapped memory.
+ * ========================================================================= */
+static int
+HostWriteHWord(void *opaque, uint32_t address, void *contents) {
+  uint8_t *host = (uint8_t*) opaque;
+  uint16_t hword;
+
+  memcpy(&hword, contents, sizeof(hword));
+  hword = ByteOrderSwap16(hword);
+  memcpy(host + (address & VR4300_PAGE_MASK), &hword, sizeof(hword));
+  return 0;
+}
+
+/* ============================================================================
+ *  HostWriteUnaligned: Writes packed unaligned data to directly-mapped memory.
+ * ========================================================================= */
+static int
+HostWriteUnaligned(void *opaque, uint32_t address, void *contents) {
+  const struct UnalignedData *data = (const struct UnalignedData*) contents;
+  uint8_t *host = (uint8_t*) opaque;
+
+  memcpy(host + (address & VR4300_PAGE_MASK), data->data, data->size);
+  return 0;
+}
+
+/* ============================================================================
+ *  HostWriteWord: Writes a word to directly-mapped memory.
+ * ========================================================================= */
+static int
+HostWriteWord(void *opaque, uint32_t address, void *contents) {
+  uint8_t *host = (uint8_t*) opaque;
+  uint32_t word;
+
+  memcpy(&word, contents, sizeof(word));
+  word = ByteOrderSwap32(word);
+  memcpy(host + (address & VR4300_PAGE_MASK), &word, sizeof(word));
+  return 0;
+}
+
+/* ============================================================================
+ *  MapPages: Points every page in [base, base + size) at the handlers.
+ *  When host memory is given, each page gets its own slice as opaque.
+ * ========================================================================= */
+static void
+MapPages(struct VR4300PageTable *table, uint32_t base, uint32_t size,
+  const struct VR4300PageHandlers *handlers, void *opaque, uint8_t *host) {
+  uint32_t first = base >> VR4300_PAGE_SHIFT;
+  uint32_t count = size >> VR4300_PAGE_SHIFT;
+  uint32_t i;
+
+  assert(!(base & VR4300_PAGE_MASK) && "Mapping isn't page aligned.");
+  assert(!(size & VR4300_PAGE_MASK) && "Mapping isn't page aligned.");
+  assert(first + count <= VR4300_NUM_PAGES && "Mapping is out of range.");
+
+  if (table->pages == NULL)
+    return;
+
+  for (i = 0; i < count; i++) {
+    struct VR4300Page *page = &table->pages[first + i];
+
+    if (host != NULL) {
+      page->opaque = host + (i << VR4300_PAGE_SHIFT);
+      page->host = host + (i << VR4300_PAGE_SHIFT);
+    }
+
+    else {
+      page->opaque = opaque;
+      page->host = NULL;
+    }
+
+    page->handlers = handlers;
+  }
+}
+
+/* ============================================================================
+ *  SwapLine: Swaps each word of a line between big-endian and host order.
+ *  The size must be a multiple of 16 bytes; src and dest may be the same.
+ * ========================================================================= */
+static void
+SwapLine(void *dest, const void *src, size_t size) {
+#ifndef LITTLE_ENDIAN
+  memmove(dest, src, size);
+#else
+  const uint8_t *in = (const uint8_t*) src;
+  uint8_t *out = (uint8_t*) dest;
+  size_t i;
+
+#ifdef USE_SSE
+  for (i = 0; i < size; i += 16) {
+    __m128i words = _mm_loadu_si128((const __m128i*) (in + i));
+
+    /* Swap the bytes of each halfword, then the halfwords of each word. */
+    words = _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8));
+    words = _mm_shufflelo_epi16(words, 0xB1);
+    words = _mm_shufflehi_epi16(words, 0xB1);
+    _mm_storeu_si128((__m128i*) (out + i), words);
+  }
+#else
+  for (i = 0; i < size; i += 4) {
+    uint32_t word;
+
+    memcpy(&word, in + i, sizeof(word));
+    word = ByteOrderSwap32(word);
+    memcpy(out + i, &word, sizeof(word));
+  }
+#endif
+#endif
+}
+
+/* ============================================================================
+ *  VR4300DestroyPageTable: Releases the page table.
+ * ========================================================================= */
+void
+VR4300DestroyPageTable(struct VR4300PageTable *table) {
+  free(table->pages);
+
+  table->pages = NULL;
+}
+
+/* ============================================================================
+ *  VR4300InitPageTable: Allocates a page table with nothing mapped.
+ *  Returns false if the table couldn't be allocated.
+ * ========================================================================= */
+bool
+VR4300InitPageTable(struct VR4300PageTable *table) {
+  table->bus = NULL;
+  table->fastmem = NULL;
+  table->writeBuffer = NULL;
+
+  if ((table->pages = (struct VR4300Page*) calloc(
+    VR4300_NUM_PAGES, sizeof(*table->pages))) == NULL) {
+    debug("Failed to allocate the page table.");
+    return false;
+  }
+
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300MapDevicePages: Caches a device's handlers for a range of pages,
+ *  so accesses there no longer have to ask the bus for them. Anything
+ *  decoded from the range before is discarded (as for the others below).
+ * ========================================================================= */
+void
+VR4300MapDevicePages(struct VR4300 *vr4300, uint32_t base, uint32_t size,
+  const struct VR4300PageHandlers *handlers, void *opaque) {
+  MapPages(&vr4300->pageTable, base, size, handlers, opaque, NULL);
+  VR4300InvalidateCode(vr4300, base, size);
+}
+
+/* ============================================================================
+ *  VR4300MapHostPages: Maps a range of pages directly onto host memory,
+ *  which must hold the guest's data in big-endian byte order. Writes to
+ *  read-only mappings (e.g., ROM) still go through the bus.
+ * ========================================================================= */
+void
+VR4300MapHostPages(struct VR4300 *vr4300, uint32_t base, uint32_t size,
+  uint8_t *host, bool writable) {
+  MapPages(&vr4300->pageTable, base, size, writable
+    ? &HostHandlers : &ReadOnlyHostHandlers, NULL, host);
+  VR4300InvalidateCode(vr4300, base, size);
+}
+
+/* ============================================================================
+ *  VR4300ReadLine: Reads a cache line's worth of memory, in big-endian byte
+ *  order, straight from host memory or with one bus call where possible.
+ * ========================================================================= */
+void
+VR4300ReadLine(const struct VR4300PageTable *table,
+  uint32_t address, uint8_t *data, size_t size) {
+  const struct VR4300Page *page = &table->pages[address >> VR4300_PAGE_SHIFT];
+  size_t i;
+
+  if (unlikely(table->writeBuffer->count))
+    VR4300DrainWriteBuffer(table);
+
+  if (likely(page->host != NULL)) {
+    memcpy(data, page->host + (address & VR4300_PAGE_MASK), size);
+    return;
+  }
+
+#ifdef __GNUC__
+  if (BusReadBlock != NULL && !BusReadBlock(table->bus, address, data, size)) {
+    SwapLine(data, data, size);
+    return;
+  }
+#endif
+
+  for (i = 0; i < size; i += 4) {
+    uint32_t word = ByteOrderSwap32(BusReadWord(table->bus, address + i));
+    memcpy(data + i, &word, sizeof(word));
+  }
+}
+
+/* ============================================================================
+ *  VR4300ReadLineWords: Like VR4300ReadLine, but leaves the words in host
+ *  byte order (for instruction fetches).
+ * ========================================================================= */
+void
+VR4300ReadLineWords(const struct VR4300PageTable *table,
+  uint32_t address, uint32_t *words, size_t size) {
+  const struct VR4300Page *page = &table->pages[address >> VR4300_PAGE_SHIFT];
+  size_t i;
+
+  if (unlikely(table->writeBuffer->count))
+    VR4300DrainWriteBuffer(table);
+
+  if (likely(page->host != NULL)) {
+    SwapLine(words, page->host + (address & VR4300_PAGE_MASK), size);
+    return;
+  }
+
+#ifdef __GNUC__
+  if (BusReadBlock != NULL && !BusReadBlock(table->bus, address, words, size))
+    return;
+#endif
+
+  for (i = 0; i < size / sizeof(*words); i++)
+    words[i] = BusReadWord(table->bus, address + (i << 2));
+}
+
+/* ============================================================================
+ *  VR4300UnmapPages: Sends a range of pages back through the bus.
+ * ========================================================================= */
+void
+VR4300UnmapPages(struct VR4300 *vr4300, uint32_t base, uint32_t size) {
+  MapPages(&vr4300->pageTable, base, size, NULL, NULL, NULL);
+  VR4300InvalidateCode(vr4300, base, size);
+}
+
+/* ============================================================================
+ *  VR4300WriteLine: Writes back a cache line (in big-endian byte order),
+ *  straight to host memory or with one bus call where possible.
+ * ========================================================================= */
+void
+VR4300WriteLine(const struct VR4300PageTable *table,
+  uint32_t address, const uint8_t *data, size_t size) {
+  const struct VR4300Page *page = &table->pages[address >> VR4300_PAGE_SHIFT];
+  MemoryFunction write;
+  void *opaque;
+  size_t i;
+
+  if (unlikely(table->writeBuffer->count))
+    VR4300DrainWriteBuffer(table);
+
+  if (likely(page->host != NULL) &&
+    page->handlers->write[BUS_TYPE_WORD] != NULL) {
+    memcpy((uint8_t*) page->opaque + (address & VR4300_PAGE_MASK), data, size);
+    return;
+  }
+
+#ifdef __GNUC__
+  if (BusWriteBlock != NULL) {
+    uint8_t words[MAX_LINE_SIZE];
+
+    assert(size <= sizeof(words) && "Line is too long.");
+    SwapLine(words, data, size);
+
+    if (!BusWriteBlock(table->bus, address, words, size))
+      return;
+  }
+#endif
+
+  write = VR4300PageWrite(table, BUS_TYPE_WORD, address, &opaque);
+
+  /* TODO: Why is if (write) needed? */
+  if (write) for (i = 0; i < size; i += 4) {
+    uint32_t word;
+
+    memcpy(&word, data + i, sizeof(word));
+    word = ByteOrderSwap32(word);
+    write(opaque, address + i, &word);
+  }
+}
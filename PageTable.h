@@ -0,0 +1,137 @@
+/* ============================================================================
+ *  PageTable.h: Physical page dispatch table (CPU side of the bus).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__PAGETABLE_H__
+#define __VR4300__PAGETABLE_H__
+#include "Common.h"
+#include "Externs.h"
+#include "WriteBuffer.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+/* 64KiB pages; small enough to keep devices apart, big enough */
+/* that the whole 32-bit physical address space is 65536 entries. */
+#define VR4300_PAGE_SHIFT 16
+#define VR4300_PAGE_SIZE (1U << VR4300_PAGE_SHIFT)
+#define VR4300_PAGE_MASK (VR4300_PAGE_SIZE - 1)
+#define VR4300_NUM_PAGES (1U << (32 - VR4300_PAGE_SHIFT))
+
+/* Physical addresses below this are RDRAM; reads have no side effects. */
+#define VR4300_RDRAM_END 0x03F00000U
+
+/* Indexed by enum BusType. */
+#define VR4300_NUM_BUS_TYPES (BUS_TYPE_DWORD + 1)
+
+/* Handlers for a device, as BusRead/BusWrite would hand them out. */
+/* A NULL entry sends that type of access through the bus instead. */
+struct VR4300PageHandlers {
+  MemoryFunction read[VR4300_NUM_BUS_TYPES];
+  MemoryFunction write[VR4300_NUM_BUS_TYPES];
+};
+
+/* Unmapped pages (NULL handlers) always fall back to the bus. Handlers */
+/* are shared rather than copied in: ten pointers a page would make the */
+/* table 6MiB, while the few handler sets in use stay in the L1 cache. */
+struct VR4300Page {
+  const struct VR4300PageHandlers *handlers;
+  void *opaque;
+
+  /* Set for directly-mapped memory (in big-endian byte order). */
+  /* Such pages use their writable slice of it as the opaque. */
+  const uint8_t *host;
+};
+
+struct VR4300PageTable {
+  struct VR4300Page *pages;
+  struct BusController *bus;
+
+  /* Base of the fastmem window, if enabled; see Fastmem.c. */
+  uint8_t *fastmem;
+
+  /* Uncached stores to RDRAM wait here; see WriteBuffer.c. */
+  struct VR4300WriteBuffer *writeBuffer;
+};
+
+struct VR4300;
+
+void VR4300DestroyPageTable(struct VR4300PageTable *);
+bool VR4300InitPageTable(struct VR4300PageTable *);
+void VR4300MapHostPages(struct VR4300 *, uint32_t, uint32_t, uint8_t *, bool);
+void VR4300MapDevicePages(struct VR4300 *, uint32_t, uint32_t,
+  const struct VR4300PageHandlers *, void *);
+void VR4300ReadLine(const struct VR4300PageTable *, uint32_t,
+  uint8_t *, size_t);
+void VR4300ReadLineWords(const struct VR4300PageTable *, uint32_t,
+  uint32_t *, size_t);
+void VR4300UnmapPages(struct VR4300 *, uint32_t, uint32_t);
+void VR4300WriteLine(const struct VR4300PageTable *, uint32_t,
+  const uint8_t *, size_t);
+
+/* ============================================================================
+ *  VR4300PageRead: Resolves a read handler for a physical address.
+ * ========================================================================= */
+static inline MemoryFunction
+VR4300PageRead(const struct VR4300PageTable *table,
+  unsigned type, uint32_t address, void **opaque) {
+  const struct VR4300Page *page = &table->pages[address >> VR4300_PAGE_SHIFT];
+  MemoryFunction read;
+
+  if (likely(page->handlers != NULL) &&
+    likely((read = page->handlers->read[type]) != NULL)) {
+    *opaque = page->opaque;
+    return read;
+  }
+
+  return BusRead(table->bus, type, address, opaque);
+}
+
+/* ============================================================================
+ *  VR4300PageReadWord: Reads an instruction word from a physical address.
+ * ========================================================================= */
+static inline uint32_t
+VR4300PageReadWord(const struct VR4300PageTable *table, uint32_t address) {
+  const struct VR4300Page *page = &table->pages[address >> VR4300_PAGE_SHIFT];
+  uint32_t word;
+
+  if (unlikely(table->writeBuffer->count))
+    VR4300DrainWriteBuffer(table);
+
+  if (likely(page->host != NULL)) {
+    memcpy(&word, page->host + (address & VR4300_PAGE_MASK), sizeof(word));
+    return ByteOrderSwap32(word);
+  }
+
+  return BusReadWord(table->bus, address);
+}
+
+/* ============================================================================
+ *  VR4300PageWrite: Resolves a write handler for a physical address.
+ * ========================================================================= */
+static inline MemoryFunction
+VR4300PageWrite(const struct VR4300PageTable *table,
+  unsigned type, uint32_t address, void **opaque) {
+  const struct VR4300Page *page = &table->pages[address >> VR4300_PAGE_SHIFT];
+  MemoryFunction write;
+
+  if (likely(page->handlers != NULL) &&
+    likely((write = page->handlers->write[type]) != NULL)) {
+    *opaque = page->opaque;
+    return write;
+  }
+
+  return BusWrite(table->bus, type, address, opaque);
+}
+
+#endif
+
@@ -25,9 +25,15 @@
 #include <string.h>
 #endif
 
+VR4300_MODE_TEMPLATE static void AdvancePipeline(struct VR4300 *);
 static void CheckForPendingInterrupts(struct VR4300 *);
 static void IncrementCycleCounters(struct VR4300 *);
 
+#ifdef __cplusplus
+template <enum VR4300AddressMode Mode> static void RunPipeline(struct VR4300 *);
+static void RunPipelineInMode(struct VR4300 *);
+#endif
+
 #ifdef DO_FASTFORWARD
 static void FastForward(struct VR4300 *);
 #endif
@@ -74,10 +80,8 @@ static const ShortPipelineFunction CycleVR4300Short[8] = {
  * ========================================================================= */
 static void
 CheckForPendingInterrupts(struct VR4300 *vr4300) {
-  uint8_t mask = vr4300->cp0.regs.cause.ip & vr4300->cp0.regs.status.im;
-
   /* There are are interrupts pending... */
-  if (mask & vr4300->cp0.interruptRaiseMask) {
+  if (vr4300->cp0.interruptPending) {
     const struct VR4300Opcode *opcode = &vr4300->pipeline.rfexLatch.opcode;
 
     /* Queue the exception up, prepare to kill stages. */
@@ -88,18 +92,21 @@ CheckForPendingInterrupts(struct VR4300 *vr4300) {
 }
 
 /* ============================================================================
- *  CycleVR4300: Advances the state of the processor pipeline one PCycle.
+ *  AdvancePipeline: Advances the state of the processor pipeline one PCycle.
+ *  Kept separate from CycleVR4300 so that VR4300Run can inline it. Stalls
+ *  and exceptions are rare, so those always use the generic stages.
  * ========================================================================= */
-void
-CycleVR4300(struct VR4300 *vr4300) {
+VR4300_MODE_TEMPLATE static inline void
+AdvancePipeline(struct VR4300 *vr4300) {
   if (!vr4300->pipeline.faultManager.faulting) {
     VR4300WBStage(vr4300);
-    VR4300DCStage(vr4300);
+    VR4300_MODE(VR4300DCStage)(vr4300);
     VR4300EXStage(vr4300);
-    VR4300RFStage(vr4300);
-    VR4300ICStage(vr4300);
+    VR4300_MODE(VR4300RFStage)(vr4300);
+    VR4300_MODE(VR4300ICStage)(vr4300);
 
-    if (!vr4300->pipeline.faultManager.faulting)
+    if (unlikely(vr4300->cp0.interruptPending) &&
+      !vr4300->pipeline.faultManager.faulting)
       CheckForPendingInterrupts(vr4300);
   }
 
@@ -118,6 +125,23 @@ CycleVR4300(struct VR4300 *vr4300) {
   IncrementCycleCounters(vr4300);
 }
 
+/* ============================================================================
+ *  CycleVR4300: Advances the state of the processor pipeline one PCycle.
+ *  Callers step other devices in between, so stores can't wait around.
+ *  Single steps always go through the generic stages.
+ * ========================================================================= */
+void
+CycleVR4300(struct VR4300 *vr4300) {
+#ifdef __cplusplus
+  AdvancePipeline<VR4300_MODE_64BIT>(vr4300);
+#else
+  AdvancePipeline(vr4300);
+#endif
+
+  if (unlikely(vr4300->writeBuffer.count))
+    VR4300DrainWriteBuffer(&vr4300->pageTable);
+}
+
 /* ============================================================================
  *  CycleVR4300_StartIC: Advances the state of the processor pipeline.
  *  The processor previously interlocked in IC; restart from here.
@@ -170,7 +194,8 @@ static void CycleVR4300_ResumeDC(struct VR4300 *vr4300) {
  * ========================================================================= */
 static void
 CycleVR4300_StartRF(struct VR4300 *vr4300) {
-  vr4300->pipeline.faultManager.excpIndex++;
+  vr4300->pipeline.faultManager.excpIndex = (enum VR4300PCUIndex)
+    (vr4300->pipeline.faultManager.excpIndex + 1);
 
   VR4300WBStage(vr4300);
   VR4300DCStage(vr4300);
@@ -184,7 +209,8 @@ CycleVR4300_StartRF(struct VR4300 *vr4300) {
  * ========================================================================= */
 static void
 CycleVR4300_StartEX(struct VR4300 *vr4300) {
-  vr4300->pipeline.faultManager.excpIndex++;
+  vr4300->pipeline.faultManager.excpIndex = (enum VR4300PCUIndex)
+    (vr4300->pipeline.faultManager.excpIndex + 1);
 
   VR4300WBStage(vr4300);
   VR4300DCStage(vr4300);
@@ -197,7 +223,8 @@ CycleVR4300_StartEX(struct VR4300 *vr4300) {
  * ========================================================================= */
 static void
 CycleVR4300_StartDC(struct VR4300 *vr4300) {
-  vr4300->pipeline.faultManager.excpIndex++;
+  vr4300->pipeline.faultManager.excpIndex = (enum VR4300PCUIndex)
+    (vr4300->pipeline.faultManager.excpIndex + 1);
 
   VR4300WBStage(vr4300);
   VR4300DCStage(vr4300);
@@ -210,20 +237,117 @@ CycleVR4300_StartDC(struct VR4300 *vr4300) {
 static void
 FastForward(struct VR4300 *vr4300) {
   CheckForPendingInterrupts(vr4300);
+
+  if (!vr4300->cp0.interruptPending)
+    VR4300SkipToNextEvent(vr4300);
 }
 #endif
 
 /* ============================================================================
  *  Bump counters, check for timer interrupts, etc. before we leave.
  * ========================================================================= */
-static void
+static inline void
 IncrementCycleCounters(struct VR4300 *vr4300) {
   vr4300->pipeline.cycles++;
 
-  /* Increment the count register; timer interrupt unlikely. */
-  vr4300->cp0.regs.count += (vr4300->pipeline.cycles & 0x01);
-  if (unlikely(vr4300->cp0.regs.count == vr4300->cp0.regs.compare))
-    vr4300->cp0.regs.cause.ip |= 0x80;
+  /* Count is derived lazily; timer interrupt unlikely. */
+  if (unlikely(vr4300->pipeline.cycles >= vr4300->cp0.compareCycle))
+    VR4300RaiseTimerInterrupt(vr4300);
+}
+
+/* ============================================================================
+ *  RunPipeline: Advances the state of the processor pipeline one PCycle,
+ *  then keeps going for as long as VR4300Run allows and the addressing
+ *  mode stays the same.
+ * ========================================================================= */
+#ifdef __cplusplus
+template <enum VR4300AddressMode Mode> static void
+RunPipeline(struct VR4300 *vr4300) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+
+  do {
+    AdvancePipeline<Mode>(vr4300);
+  } while (pipeline->cycles < pipeline->runUntil &&
+    vr4300->regionMap.mode == Mode);
+}
+
+/* ============================================================================
+ *  RunPipelineInMode: Runs the pipeline specialized for the current mode.
+ * ========================================================================= */
+static void
+RunPipelineInMode(struct VR4300 *vr4300) {
+  switch (vr4300->regionMap.mode) {
+    case VR4300_MODE_KERNEL32:
+      RunPipeline<VR4300_MODE_KERNEL32>(vr4300);
+      break;
+
+    case VR4300_MODE_USER32:
+      RunPipeline<VR4300_MODE_USER32>(vr4300);
+      break;
+
+    default:
+      RunPipeline<VR4300_MODE_64BIT>(vr4300);
+      break;
+  }
+}
+#endif
+
+/* ============================================================================
+ *  VR4300SkipToNextEvent: Called when the processor is idle. Nothing can
+ *  happen until the next timer event, or until VR4300Run hands control
+ *  back to the embedder; advance the cycle counter to just before that.
+ * ========================================================================= */
+void
+VR4300SkipToNextEvent(struct VR4300 *vr4300) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  unsigned long long until;
+
+  if (!pipeline->runUntil)
+    return;
+
+  until = pipeline->runUntil < vr4300->cp0.compareCycle
+    ? pipeline->runUntil : vr4300->cp0.compareCycle;
+
+  if (until - 1 > pipeline->cycles)
+    pipeline->cycles = until - 1;
+}
+
+/* ============================================================================
+ *  VR4300Run: Advances the processor pipeline by up to `cycles` PCycles.
+ *  Returns early (after the current PCycle) if VR4300StopRun is invoked,
+ *  i.e., from a bus callback or when an RCP interrupt is raised. Returns
+ *  the number of PCycles that were actually executed.
+ * ========================================================================= */
+unsigned long long
+VR4300Run(struct VR4300 *vr4300, unsigned long long cycles) {
+  struct VR4300Pipeline *pipeline = &vr4300->pipeline;
+  unsigned long long start = pipeline->cycles;
+
+  pipeline->runUntil = start + cycles;
+
+  while (pipeline->cycles < pipeline->runUntil) {
+#ifdef __cplusplus
+    RunPipelineInMode(vr4300);
+#else
+    AdvancePipeline(vr4300);
+#endif
+  }
+
+#ifdef DO_FASTFORWARD
+  VR4300LeaveIdleLoop(vr4300);
+#endif
+
+  VR4300DrainWriteBuffer(&vr4300->pageTable);
+  pipeline->runUntil = 0;
+  return pipeline->cycles - start;
+}
+
+/* ============================================================================
+ *  VR4300StopRun: Forces VR4300Run to return once the current PCycle ends.
+ * ========================================================================= */
+void
+VR4300StopRun(struct VR4300 *vr4300) {
+  vr4300->pipeline.runUntil = 0;
 }
 
 /* ============================================================================
@@ -262,11 +386,15 @@ VR4300DumpStatistics(struct VR4300 *vr4300) {
  * ========================================================================= */
 void
 VR4300InitPipeline(struct VR4300Pipeline *pipeline) {
+  unsigned i;
+
   memset(pipeline, 0, sizeof(*pipeline));
 
   /* Validate the cached regions. */
   pipeline->icrfLatch.region = GetDefaultRegion();
-  pipeline->dcwbLatch.region = GetDefaultRegion();
+
+  for (i = 0; i < VR4300_DC_REGIONS; i++)
+    pipeline->dcwbLatch.regions[i] = GetDefaultRegion();
 
   InitFaultManager(&pipeline->faultManager);
 }
@@ -14,6 +14,7 @@
 #include "Decoder.h"
 #include "DCStage.h"
 #include "Fault.h"
+#include "IdleLoop.h"
 #include "Latches.h"
 #include "Region.h"
 
@@ -27,6 +28,11 @@ struct VR4300Pipeline {
   struct VR4300FaultManager faultManager;
 
   unsigned long long cycles;
+  unsigned long long runUntil;
+
+#ifdef DO_FASTFORWARD
+  struct VR4300IdleLoop idle;
+#endif
 };
 
 struct VR4300;
@@ -34,5 +40,9 @@ struct VR4300;
 void CycleVR4300(struct VR4300 *);
 void VR4300InitPipeline(struct VR4300Pipeline *);
 
+unsigned long long VR4300Run(struct VR4300 *, unsigned long long);
+void VR4300StopRun(struct VR4300 *);
+void VR4300SkipToNextEvent(struct VR4300 *);
+
 #endif
 
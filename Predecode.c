@@ -0,0 +1,130 @@
+/* ============================================================================
+ *  Predecode.c: Decoded instructions for uncached instruction fetches.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "Decoder.h"
+#include "PageTable.h"
+#include "Predecode.h"
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/* ============================================================================
+ *  VR4300DestroyPredecodeCache: Releases the entries, if any.
+ * ========================================================================= */
+void
+VR4300DestroyPredecodeCache(struct VR4300PredecodeCache *cache) {
+  free(cache->entries);
+  cache->entries = NULL;
+}
+
+/* ============================================================================
+ *  VR4300EnablePredecodeCache: Allocates the entries. Until this is called,
+ *  uncached fetches read and decode every instruction. Once it has been,
+ *  anything (i.e., DMA) writing code that the CPU doesn't store itself
+ *  must be reported with VR4300InvalidatePredecode.
+ * ========================================================================= */
+bool
+VR4300EnablePredecodeCache(struct VR4300PredecodeCache *cache) {
+  if (cache->entries == NULL && (cache->entries = (struct
+    VR4300PredecodeEntry*) malloc(VR4300_PREDECODE_SIZE *
+    sizeof(*cache->entries))) == NULL) {
+    debug("Failed to allocate memory.");
+    return false;
+  }
+
+  VR4300FlushPredecodeCache(cache);
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300FillPredecodeEntry: Reads and decodes an instruction. Only code in
+ *  pages that stores are checked against is remembered, though.
+ * ========================================================================= */
+void
+VR4300FillPredecodeEntry(struct VR4300PredecodeCache *cache,
+  const struct VR4300PageTable *pages, struct VR4300PredecodeEntry *entry,
+  uint32_t paddr) {
+  uint32_t iw = VR4300PageReadWord(pages, paddr);
+
+  entry->opcode = *VR4300DecodeInstruction(iw);
+  entry->iw = iw;
+
+  VR4300DecodeOperands(iw, &entry->operands);
+
+  entry->paddr = VR4300MarkCodePage(cache->codePages, paddr)
+    ? paddr : VR4300_PREDECODE_INVALID;
+}
+
+/* ============================================================================
+ *  VR4300FlushPredecodeCache: Invalidates every entry in the cache.
+ * ========================================================================= */
+void
+VR4300FlushPredecodeCache(struct VR4300PredecodeCache *cache) {
+  unsigned i;
+
+  if (cache->entries == NULL)
+    return;
+
+  for (i = 0; i < VR4300_PREDECODE_SIZE; i++)
+    cache->entries[i].paddr = VR4300_PREDECODE_INVALID;
+}
+
+/* ============================================================================
+ *  VR4300InitPredecodeCache: Initializes the cache. It starts out disabled.
+ * ========================================================================= */
+void
+VR4300InitPredecodeCache(struct VR4300PredecodeCache *cache) {
+  memset(cache, 0, sizeof(*cache));
+}
+
+/* ============================================================================
+ *  VR4300InvalidatePredecode: Invalidates any entry within the range.
+ * ========================================================================= */
+void
+VR4300InvalidatePredecode(struct VR4300PredecodeCache *cache,
+  uint32_t paddr, uint32_t length) {
+  uint32_t address, end = paddr + length;
+  unsigned i;
+
+  if (cache->entries == NULL)
+    return;
+
+  /* Cheaper to check every entry than every word of a big range. */
+  if (length >= VR4300_PREDECODE_SIZE << 2) {
+    for (i = 0; i < VR4300_PREDECODE_SIZE; i++) {
+      if (cache->entries[i].paddr - paddr < length)
+        cache->entries[i].paddr = VR4300_PREDECODE_INVALID;
+    }
+
+    return;
+  }
+
+  for (address = paddr & ~0x3U; address < end; address += 4) {
+    struct VR4300PredecodeEntry *entry = cache->entries +
+      (address >> 2 & (VR4300_PREDECODE_SIZE - 1));
+
+    /* Skip the rest of any page that nothing was decoded from. */
+    if (address < VR4300_CODE_LIMIT &&
+      !VR4300IsCodePage(cache->codePages, address)) {
+      address = (address | 0xFFF) - 3;
+      continue;
+    }
+
+    if (entry->paddr == address)
+      entry->paddr = VR4300_PREDECODE_INVALID;
+  }
+}
+
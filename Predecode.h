@@ -0,0 +1,64 @@
+/* ============================================================================
+ *  Predecode.h: Decoded instructions for uncached instruction fetches.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__PREDECODE_H__
+#define __VR4300__PREDECODE_H__
+#include "Common.h"
+#include "CodePages.h"
+#include "Decoder.h"
+#include "PageTable.h"
+
+/* Direct-mapped by physical word address; enough for IPL code. */
+#define VR4300_PREDECODE_SIZE 2048
+
+/* Never a fetch address (those are word aligned). */
+#define VR4300_PREDECODE_INVALID 0xFFFFFFFFU
+
+struct VR4300PredecodeEntry {
+  struct VR4300Opcode opcode;
+  struct VR4300Operands operands;
+  uint32_t iw;
+  uint32_t paddr;
+};
+
+struct VR4300PredecodeCache {
+  struct VR4300PredecodeEntry *entries;
+
+  /* Shared with the block cache; owned by the CPU. */
+  struct VR4300CodePages *codePages;
+};
+
+void VR4300DestroyPredecodeCache(struct VR4300PredecodeCache *);
+bool VR4300EnablePredecodeCache(struct VR4300PredecodeCache *);
+void VR4300FillPredecodeEntry(struct VR4300PredecodeCache *,
+  const struct VR4300PageTable *, struct VR4300PredecodeEntry *, uint32_t);
+void VR4300FlushPredecodeCache(struct VR4300PredecodeCache *);
+void VR4300InitPredecodeCache(struct VR4300PredecodeCache *);
+void VR4300InvalidatePredecode(struct VR4300PredecodeCache *,
+  uint32_t, uint32_t);
+
+/* ============================================================================
+ *  VR4300FetchPredecoded: Returns the decoded instruction at a physical
+ *  address, reading and decoding it only if it isn't in the cache yet.
+ * ========================================================================= */
+static inline const struct VR4300PredecodeEntry *
+VR4300FetchPredecoded(struct VR4300PredecodeCache *cache,
+  const struct VR4300PageTable *pages, uint32_t paddr) {
+  struct VR4300PredecodeEntry *entry = cache->entries +
+    (paddr >> 2 & (VR4300_PREDECODE_SIZE - 1));
+
+  if (unlikely(entry->paddr != paddr))
+    VR4300FillPredecodeEntry(cache, pages, entry, paddr);
+
+  return entry;
+}
+
+#endif
+
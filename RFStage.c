@@ -14,6 +14,7 @@
 #include "Fault.h"
 #include "ICache.h"
 #include "Pipeline.h"
+#include "Predecode.h"
 
 #ifdef __cplusplus
 #include <cassert>
@@ -40,7 +41,7 @@ ProduceLatchOutputs(uint32_t iwMask,
 #ifdef USE_SSE
     unsigned index = iwMask + 1;
     static const uint32_t maskTable[2][4] align(16) =
-      {{~0, ~0, ~0, ~0},
+      {{~0U, ~0U, ~0U, ~0U},
        { 0,  0,  0,  0}};
 
     assert(sizeof(*cacheData) == 16);
@@ -51,15 +52,20 @@ ProduceLatchOutputs(uint32_t iwMask,
     _mm_storeu_si128((__m128i*) &rfexLatch->opcode, data);
 #else
     rfexLatch->iw = cacheData->word & iwMask;
-    rfexLatch->opcode.id = cacheData->opcode.id & iwMask;
+    rfexLatch->opcode.id = (enum VR4300OpcodeID)
+      (cacheData->opcode.id & iwMask);
     rfexLatch->opcode.flags = cacheData->opcode.flags & iwMask;
+    rfexLatch->operands.rs = cacheData->operands.rs & iwMask;
+    rfexLatch->operands.rt = cacheData->operands.rt & iwMask;
+    rfexLatch->operands.rd = cacheData->operands.rd & iwMask;
+    rfexLatch->operands.sa = cacheData->operands.sa & iwMask;
 #endif
 }
 
 /* ============================================================================
  *  VR4300RFStage: Decodes instructions, reads from cache, grabs registers.
  * ========================================================================= */
-void
+VR4300_MODE_TEMPLATE void
 VR4300RFStage(struct VR4300 *vr4300) {
   struct VR4300ICRFLatch *icrfLatch = &vr4300->pipeline.icrfLatch;
   struct VR4300RFEXLatch *rfexLatch = &vr4300->pipeline.rfexLatch;
@@ -67,11 +73,11 @@ VR4300RFStage(struct VR4300 *vr4300) {
   uint32_t paddr = vaddr;
 
   /* Is the region mapped? */
-  if (icrfLatch->region->mapped) {
-    debugarg("TLB Code Access: Address: 0x%.8X.", address);
+  if (VR4300RegionMapped(VR4300_THIS_MODE, icrfLatch->region)) {
+    debugarg("TLB Code Access: Address: 0x%.16lX.", vaddr);
 
-    if (!VR4300Translate(vr4300, vaddr, &paddr)) {
-      debugarg("TLB Miss: Address: 0x%.8X.", address);
+    if (!VR4300TranslateCode(vr4300, vaddr, &paddr)) {
+      debugarg("TLB Miss: Address: 0x%.16lX.", vaddr);
       debug("Unimplemented fault: VR4300_TLB_...");
     }
 
@@ -82,7 +88,7 @@ VR4300RFStage(struct VR4300 *vr4300) {
   }
 
   /* Is the region cache-able? */
-  if (likely(icrfLatch->region->cached)) {
+  if (likely(VR4300RegionCached(VR4300_THIS_MODE, icrfLatch->region))) {
     const struct VR4300ICacheLineData *cacheData;
     cacheData = VR4300ICacheProbe(&vr4300->icache, vaddr, paddr);
 
@@ -102,14 +108,29 @@ VR4300RFStage(struct VR4300 *vr4300) {
     ProduceLatchOutputs(icrfLatch->iwMask, cacheData, rfexLatch);
   }
 
+  /* Region isn't cachable, but we've decoded the word before. */
+  else if (vr4300->predecode.entries != NULL && likely(icrfLatch->iwMask)) {
+    const struct VR4300PredecodeEntry *entry = VR4300FetchPredecoded(
+      &vr4300->predecode, &vr4300->pageTable, paddr);
+
+    rfexLatch->opcode = entry->opcode;
+    rfexLatch->operands = entry->operands;
+    rfexLatch->iw = entry->iw;
+  }
+
   /* Region isn't cachable; fetch a word from memory. */
   /* Manually force instruction to invalid if iwMask == 0. */
   else {
-    uint32_t iw = BusReadWord(vr4300->bus, paddr) & icrfLatch->iwMask;
+    uint32_t iw = VR4300PageReadWord(&vr4300->pageTable, paddr);
+
+    iw &= icrfLatch->iwMask;
 
     rfexLatch->opcode = *VR4300DecodeInstruction(iw);
-    rfexLatch->opcode.id &= icrfLatch->iwMask;
+    rfexLatch->opcode.id = (enum VR4300OpcodeID)
+      (rfexLatch->opcode.id & icrfLatch->iwMask);
     rfexLatch->iw = iw;
+
+    VR4300DecodeOperands(iw, &rfexLatch->operands);
   }
 
   /* Forward and update the PC. */
@@ -120,3 +141,17 @@ VR4300RFStage(struct VR4300 *vr4300) {
   icrfLatch->iwMask = ~0;
 }
 
+/* ============================================================================
+ *  Exported stage; the instantiations for each addressing mode.
+ * ========================================================================= */
+#ifdef __cplusplus
+template void VR4300RFStage<VR4300_MODE_KERNEL32>(struct VR4300 *);
+template void VR4300RFStage<VR4300_MODE_USER32>(struct VR4300 *);
+template void VR4300RFStage<VR4300_MODE_64BIT>(struct VR4300 *);
+
+void
+VR4300RFStage(struct VR4300 *vr4300) {
+  VR4300RFStage<VR4300_MODE_64BIT>(vr4300);
+}
+#endif
+
@@ -16,5 +16,9 @@
 
 void VR4300RFStage(struct VR4300 *);
 
+#ifdef __cplusplus
+template <enum VR4300AddressMode Mode> void VR4300RFStage(struct VR4300 *);
+#endif
+
 #endif
 
@@ -0,0 +1,658 @@
+/* ============================================================================
+ *  Recompiler.c: x86-64 recompiler for straight-line integer code.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "Common.h"
+#include "BlockCache.h"
+#include "CPU.h"
+#include "Decoder.h"
+#include "Opcodes.h"
+#include "Recompiler.h"
+
+#ifdef __cplusplus
+#include <cassert>
+#include <cstring>
+#else
+#include <assert.h>
+#include <string.h>
+#endif
+
+#ifdef USE_RECOMPILER
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Worst case amount of code emitted for one block. */
+#define VR4300_RECOMPILER_BLOCK_BYTES 4096
+
+/* Host registers; rdi holds the guest register file. */
+enum HostRegister {
+  HOST_RAX = 0, HOST_RCX = 1, HOST_RDX = 2, HOST_RSI = 6,
+  HOST_R8 = 8, HOST_R9 = 9, HOST_R10 = 10, HOST_R11 = 11,
+};
+
+/* Caller-saved registers used to cache guest registers. */
+#define NUM_HOST_REGISTERS 6
+static const uint8_t HostRegisters[NUM_HOST_REGISTERS] = {
+  HOST_RDX, HOST_RSI, HOST_R8, HOST_R9, HOST_R10, HOST_R11
+};
+
+/* x86 opcodes and /digit extensions used below. */
+enum HostOpcode {
+  X86_ADD = 0x01, X86_OR = 0x09, X86_AND = 0x21, X86_SUB = 0x29,
+  X86_XOR = 0x31, X86_CMP = 0x39, X86_MOV = 0x89, X86_LOAD = 0x8B,
+};
+
+enum HostExtension {
+  X86_EXT_ADD = 0, X86_EXT_OR = 1, X86_EXT_AND = 4, X86_EXT_XOR = 6,
+  X86_EXT_CMP = 7, X86_EXT_SHL = 4, X86_EXT_SHR = 5, X86_EXT_SAR = 7,
+};
+
+struct Emitter {
+  uint8_t *code;
+  uint8_t *start;
+
+  /* Which guest register each host register holds (0 if none). */
+  unsigned guest[NUM_HOST_REGISTERS];
+  unsigned lastUse[NUM_HOST_REGISTERS];
+  bool dirty[NUM_HOST_REGISTERS];
+  unsigned clock;
+};
+
+static bool CanRecompile(const struct VR4300BlockInstruction *);
+static void Compile(struct Emitter *, const struct VR4300BlockInstruction *);
+static void Emit32(struct Emitter *, uint32_t);
+static void EmitImmediate(struct Emitter *, unsigned, unsigned, int32_t, bool);
+static void EmitMemory(struct Emitter *, unsigned, unsigned, unsigned);
+static void EmitRegister(struct Emitter *, unsigned, unsigned, unsigned, bool);
+static void EmitSetCC(struct Emitter *, uint8_t);
+static void EmitShift(struct Emitter *, unsigned, unsigned, unsigned, bool);
+static void EmitSignExtend(struct Emitter *);
+static void FlushRegisters(struct Emitter *);
+static unsigned GetHostRegister(struct Emitter *, unsigned, bool);
+static bool MapBuffer(struct VR4300Recompiler *);
+static void ReadGuest(struct Emitter *, unsigned, unsigned);
+static void WriteGuest(struct Emitter *, unsigned);
+
+/* ============================================================================
+ *  CanRecompile: Returns true if the instruction has no side effects other
+ *  than writing the register file, and is understood by Compile.
+ * ========================================================================= */
+static bool
+CanRecompile(const struct VR4300BlockInstruction *instruction) {
+  switch (instruction->opcode.id) {
+    case VR4300_OPCODE_ADD_ADDU_SUB_SUBU:
+    case VR4300_OPCODE_ADDI_SUBI_ADDIU_SUBIU:
+    case VR4300_OPCODE_AND: case VR4300_OPCODE_ANDI:
+    case VR4300_OPCODE_DADD: case VR4300_OPCODE_DADDI:
+    case VR4300_OPCODE_DADDIU: case VR4300_OPCODE_DADDU:
+    case VR4300_OPCODE_DSLL: case VR4300_OPCODE_DSLL32:
+    case VR4300_OPCODE_DSLLV: case VR4300_OPCODE_DSRA:
+    case VR4300_OPCODE_DSRA32: case VR4300_OPCODE_DSRAV:
+    case VR4300_OPCODE_DSRL: case VR4300_OPCODE_DSRL32:
+    case VR4300_OPCODE_DSRLV: case VR4300_OPCODE_DSUB:
+    case VR4300_OPCODE_DSUBU: case VR4300_OPCODE_LI:
+    case VR4300_OPCODE_LUI: case VR4300_OPCODE_MFHI:
+    case VR4300_OPCODE_MFLO: case VR4300_OPCODE_MOVE:
+    case VR4300_OPCODE_MTHI: case VR4300_OPCODE_MTLO:
+    case VR4300_OPCODE_NOP: case VR4300_OPCODE_NOR:
+    case VR4300_OPCODE_OR:
+    case VR4300_OPCODE_ORI: case VR4300_OPCODE_SLL:
+    case VR4300_OPCODE_SLLV: case VR4300_OPCODE_SLT:
+    case VR4300_OPCODE_SLTI: case VR4300_OPCODE_SLTIU:
+    case VR4300_OPCODE_SLTU: case VR4300_OPCODE_SRA:
+    case VR4300_OPCODE_SRAV: case VR4300_OPCODE_SRL:
+    case VR4300_OPCODE_SRLV: case VR4300_OPCODE_XOR:
+    case VR4300_OPCODE_XORI:
+      return true;
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
+/* ============================================================================
+ *  Compile: Emits code for a single instruction. Results are computed in
+ *  rax (with rcx as a second operand), then cached in a host register.
+ * ========================================================================= */
+static void
+Compile(struct Emitter *e, const struct VR4300BlockInstruction *instruction) {
+  uint32_t iw = instruction->iw;
+  unsigned rs = GET_RS(iw), rt = GET_RT(iw), rd = GET_RD(iw);
+  unsigned sa = iw >> 6 & 0x1F;
+  int32_t simm = (int16_t) iw;
+  int32_t uimm = (uint16_t) iw;
+
+  switch (instruction->opcode.id) {
+    case VR4300_OPCODE_ADD_ADDU_SUB_SUBU:
+      ReadGuest(e, HOST_RAX, rs);
+      ReadGuest(e, HOST_RCX, rt);
+      EmitRegister(e, iw >> 1 & 0x1 ? X86_SUB : X86_ADD,
+        HOST_RAX, HOST_RCX, false);
+      EmitSignExtend(e);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_ADDI_SUBI_ADDIU_SUBIU:
+      ReadGuest(e, HOST_RAX, rs);
+      EmitImmediate(e, X86_EXT_ADD, HOST_RAX, simm, false);
+      EmitSignExtend(e);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_AND:
+    case VR4300_OPCODE_NOR:
+    case VR4300_OPCODE_OR:
+    case VR4300_OPCODE_XOR:
+    case VR4300_OPCODE_DADD:
+    case VR4300_OPCODE_DADDU:
+    case VR4300_OPCODE_DSUB:
+    case VR4300_OPCODE_DSUBU:
+      ReadGuest(e, HOST_RAX, rs);
+      ReadGuest(e, HOST_RCX, rt);
+
+      switch (instruction->opcode.id) {
+        case VR4300_OPCODE_AND:
+          EmitRegister(e, X86_AND, HOST_RAX, HOST_RCX, true);
+          break;
+
+        case VR4300_OPCODE_NOR:
+          EmitRegister(e, X86_OR, HOST_RAX, HOST_RCX, true);
+          *e->code++ = 0x48; *e->code++ = 0xF7; *e->code++ = 0xD0;
+          break;
+
+        case VR4300_OPCODE_OR:
+          EmitRegister(e, X86_OR, HOST_RAX, HOST_RCX, true);
+          break;
+
+        case VR4300_OPCODE_XOR:
+          EmitRegister(e, X86_XOR, HOST_RAX, HOST_RCX, true);
+          break;
+
+        case VR4300_OPCODE_DADD:
+        case VR4300_OPCODE_DADDU:
+          EmitRegister(e, X86_ADD, HOST_RAX, HOST_RCX, true);
+          break;
+
+        default:
+          EmitRegister(e, X86_SUB, HOST_RAX, HOST_RCX, true);
+          break;
+      }
+
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_ANDI:
+      ReadGuest(e, HOST_RAX, rs);
+      EmitImmediate(e, X86_EXT_AND, HOST_RAX, uimm, true);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_ORI:
+      ReadGuest(e, HOST_RAX, rs);
+      EmitImmediate(e, X86_EXT_OR, HOST_RAX, uimm, true);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_XORI:
+      ReadGuest(e, HOST_RAX, rs);
+      EmitImmediate(e, X86_EXT_XOR, HOST_RAX, uimm, true);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_DADDI:
+    case VR4300_OPCODE_DADDIU:
+      ReadGuest(e, HOST_RAX, rs);
+      EmitImmediate(e, X86_EXT_ADD, HOST_RAX, simm, true);
+      WriteGuest(e, rt);
+      break;
+
+    /* mov rax, imm32 (sign-extended). */
+    case VR4300_OPCODE_LI:
+      *e->code++ = 0x48; *e->code++ = 0xC7; *e->code++ = 0xC0;
+      Emit32(e, simm);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_LUI:
+      *e->code++ = 0x48; *e->code++ = 0xC7; *e->code++ = 0xC0;
+      Emit32(e, iw << 16);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_MOVE:
+      ReadGuest(e, HOST_RAX, rs);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_NOP:
+      break;
+
+    case VR4300_OPCODE_SLT:
+    case VR4300_OPCODE_SLTU:
+      ReadGuest(e, HOST_RAX, rs);
+      ReadGuest(e, HOST_RCX, rt);
+      EmitRegister(e, X86_CMP, HOST_RAX, HOST_RCX, true);
+      EmitSetCC(e, instruction->opcode.id == VR4300_OPCODE_SLT ? 0x9C : 0x92);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_SLTI:
+    case VR4300_OPCODE_SLTIU:
+      ReadGuest(e, HOST_RAX, rs);
+      EmitImmediate(e, X86_EXT_CMP, HOST_RAX, simm, true);
+      EmitSetCC(e, instruction->opcode.id == VR4300_OPCODE_SLTI ? 0x9C : 0x92);
+      WriteGuest(e, rt);
+      break;
+
+    case VR4300_OPCODE_SLL:
+    case VR4300_OPCODE_SRA:
+    case VR4300_OPCODE_SRL:
+      ReadGuest(e, HOST_RAX, rt);
+      EmitShift(e, instruction->opcode.id == VR4300_OPCODE_SLL ? X86_EXT_SHL :
+        instruction->opcode.id == VR4300_OPCODE_SRA ? X86_EXT_SAR :
+        X86_EXT_SHR, HOST_RAX, sa, false);
+      EmitSignExtend(e);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_SLLV:
+    case VR4300_OPCODE_SRAV:
+    case VR4300_OPCODE_SRLV:
+      ReadGuest(e, HOST_RCX, rs);
+      ReadGuest(e, HOST_RAX, rt);
+      EmitShift(e, instruction->opcode.id == VR4300_OPCODE_SLLV ? X86_EXT_SHL :
+        instruction->opcode.id == VR4300_OPCODE_SRAV ? X86_EXT_SAR :
+        X86_EXT_SHR, HOST_RAX, ~0U, false);
+      EmitSignExtend(e);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_DSLL:
+    case VR4300_OPCODE_DSLL32:
+    case VR4300_OPCODE_DSRA:
+    case VR4300_OPCODE_DSRA32:
+    case VR4300_OPCODE_DSRL:
+    case VR4300_OPCODE_DSRL32:
+      ReadGuest(e, HOST_RAX, rt);
+
+      if (instruction->opcode.id == VR4300_OPCODE_DSLL32 ||
+        instruction->opcode.id == VR4300_OPCODE_DSRA32 ||
+        instruction->opcode.id == VR4300_OPCODE_DSRL32)
+        sa += 32;
+
+      EmitShift(e, instruction->opcode.id == VR4300_OPCODE_DSLL ||
+        instruction->opcode.id == VR4300_OPCODE_DSLL32 ? X86_EXT_SHL :
+        instruction->opcode.id == VR4300_OPCODE_DSRA ||
+        instruction->opcode.id == VR4300_OPCODE_DSRA32 ? X86_EXT_SAR :
+        X86_EXT_SHR, HOST_RAX, sa, true);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_DSLLV:
+    case VR4300_OPCODE_DSRAV:
+    case VR4300_OPCODE_DSRLV:
+      ReadGuest(e, HOST_RCX, rs);
+      ReadGuest(e, HOST_RAX, rt);
+      EmitShift(e, instruction->opcode.id == VR4300_OPCODE_DSLLV ? X86_EXT_SHL :
+        instruction->opcode.id == VR4300_OPCODE_DSRAV ? X86_EXT_SAR :
+        X86_EXT_SHR, HOST_RAX, ~0U, true);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_MFHI:
+      ReadGuest(e, HOST_RAX, VR4300_REGISTER_HI);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_MFLO:
+      ReadGuest(e, HOST_RAX, VR4300_REGISTER_LO);
+      WriteGuest(e, rd);
+      break;
+
+    case VR4300_OPCODE_MTHI:
+      ReadGuest(e, HOST_RAX, rs);
+      WriteGuest(e, VR4300_REGISTER_HI);
+      break;
+
+    case VR4300_OPCODE_MTLO:
+      ReadGuest(e, HOST_RAX, rs);
+      WriteGuest(e, VR4300_REGISTER_LO);
+      break;
+
+    default:
+      assert(0 && "Opcode can't be recompiled.");
+      break;
+  }
+}
+
+/* ============================================================================
+ *  Emit32: Emits a little-endian 32-bit value.
+ * ========================================================================= */
+static void
+Emit32(struct Emitter *e, uint32_t value) {
+  *e->code++ = value;
+  *e->code++ = value >> 8;
+  *e->code++ = value >> 16;
+  *e->code++ = value >> 24;
+}
+
+/* ============================================================================
+ *  EmitImmediate: <op> reg, imm32 (81 /ext id).
+ * ========================================================================= */
+static void
+EmitImmediate(struct Emitter *e, unsigned ext,
+  unsigned reg, int32_t imm, bool wide) {
+  unsigned rex = 0x40 | (wide ? 0x8 : 0) | (reg >> 3);
+
+  if (rex != 0x40)
+    *e->code++ = rex;
+
+  *e->code++ = 0x81;
+  *e->code++ = 0xC0 | ext << 3 | (reg & 0x7);
+  Emit32(e, imm);
+}
+
+/* ============================================================================
+ *  EmitMemory: <op> reg, [rdi + guest * 8] (loads and stores).
+ * ========================================================================= */
+static void
+EmitMemory(struct Emitter *e, unsigned op, unsigned reg, unsigned guest) {
+  *e->code++ = 0x48 | (reg >> 3) << 2;
+  *e->code++ = op;
+  *e->code++ = 0x87 | (reg & 0x7) << 3;
+  Emit32(e, guest * sizeof(uint64_t));
+}
+
+/* ============================================================================
+ *  EmitRegister: <op> dest, src (for MR-form opcodes).
+ * ========================================================================= */
+static void
+EmitRegister(struct Emitter *e, unsigned op,
+  unsigned dest, unsigned src, bool wide) {
+  unsigned rex = 0x40 | (wide ? 0x8 : 0) | (src >> 3) << 2 | (dest >> 3);
+
+  if (rex != 0x40)
+    *e->code++ = rex;
+
+  *e->code++ = op;
+  *e->code++ = 0xC0 | (src & 0x7) << 3 | (dest & 0x7);
+}
+
+/* ============================================================================
+ *  EmitSetCC: set<cc> al; movzx eax, al.
+ * ========================================================================= */
+static void
+EmitSetCC(struct Emitter *e, uint8_t cc) {
+  *e->code++ = 0x0F; *e->code++ = cc; *e->code++ = 0xC0;
+  *e->code++ = 0x0F; *e->code++ = 0xB6; *e->code++ = 0xC0;
+}
+
+/* ============================================================================
+ *  EmitShift: <op> reg, imm8 (or cl, when the amount is ~0U).
+ * ========================================================================= */
+static void
+EmitShift(struct Emitter *e, unsigned ext,
+  unsigned reg, unsigned amount, bool wide) {
+  unsigned rex = 0x40 | (wide ? 0x8 : 0) | (reg >> 3);
+
+  if (amount == 0)
+    return;
+
+  if (rex != 0x40)
+    *e->code++ = rex;
+
+  *e->code++ = amount == ~0U ? 0xD3 : 0xC1;
+  *e->code++ = 0xC0 | ext << 3 | (reg & 0x7);
+
+  if (amount != ~0U)
+    *e->code++ = amount;
+}
+
+/* ============================================================================
+ *  EmitSignExtend: movsxd rax, eax.
+ * ========================================================================= */
+static void
+EmitSignExtend(struct Emitter *e) {
+  *e->code++ = 0x48; *e->code++ = 0x63; *e->code++ = 0xC0;
+}
+
+/* ============================================================================
+ *  FlushRegisters: Writes back dirty guest registers and returns.
+ * ========================================================================= */
+static void
+FlushRegisters(struct Emitter *e) {
+  unsigned i;
+
+  for (i = 0; i < NUM_HOST_REGISTERS; i++) {
+    if (e->guest[i] && e->dirty[i])
+      EmitMemory(e, X86_MOV, HostRegisters[i], e->guest[i]);
+  }
+
+  *e->code++ = 0xC3;
+}
+
+/* ============================================================================
+ *  GetHostRegister: Returns the host register caching a guest register,
+ *  evicting the least recently used one if needed.
+ * ========================================================================= */
+static unsigned
+GetHostRegister(struct Emitter *e, unsigned guest, bool load) {
+  unsigned i, victim = 0;
+
+  for (i = 0; i < NUM_HOST_REGISTERS; i++) {
+    if (e->guest[i] == guest)
+      break;
+
+    if (e->lastUse[i] < e->lastUse[victim])
+      victim = i;
+  }
+
+  if (i == NUM_HOST_REGISTERS) {
+    i = victim;
+
+    if (e->guest[i] && e->dirty[i])
+      EmitMemory(e, X86_MOV, HostRegisters[i], e->guest[i]);
+
+    if (load)
+      EmitMemory(e, X86_LOAD, HostRegisters[i], guest);
+
+    e->guest[i] = guest;
+    e->dirty[i] = false;
+  }
+
+  e->lastUse[i] = ++e->clock;
+  return HostRegisters[i];
+}
+
+/* ============================================================================
+ *  MapBuffer: Maps the code buffer twice over the same memory: read-write
+ *  for the emitter, and read-execute to run what it emitted from.
+ * ========================================================================= */
+static bool
+MapBuffer(struct VR4300Recompiler *recompiler) {
+  void *buffer, *executable;
+  int fd;
+
+  if ((fd = memfd_create("vr4300-recompiler", 0)) < 0)
+    return false;
+
+  if (ftruncate(fd, VR4300_RECOMPILER_BUFFER_SIZE) || (buffer = mmap(NULL,
+    VR4300_RECOMPILER_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+    fd, 0)) == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+
+  executable = mmap(NULL, VR4300_RECOMPILER_BUFFER_SIZE,
+    PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if (executable == MAP_FAILED) {
+    munmap(buffer, VR4300_RECOMPILER_BUFFER_SIZE);
+    return false;
+  }
+
+  recompiler->buffer = (uint8_t*) buffer;
+  recompiler->executable = (uint8_t*) executable;
+  recompiler->used = 0;
+  return true;
+}
+
+/* ============================================================================
+ *  ReadGuest: Copies a guest register to a scratch register. $zero isn't
+ *  read from the register file, as the interpreter may leave junk in it.
+ * ========================================================================= */
+static void
+ReadGuest(struct Emitter *e, unsigned scratch, unsigned guest) {
+  if (guest == VR4300_REGISTER_ZERO)
+    EmitRegister(e, X86_XOR, scratch, scratch, false);
+
+  else
+    EmitRegister(e, X86_MOV, scratch,
+      GetHostRegister(e, guest, true), true);
+}
+
+/* ============================================================================
+ *  WriteGuest: Caches the result in rax as the new value of a register.
+ * ========================================================================= */
+static void
+WriteGuest(struct Emitter *e, unsigned guest) {
+  unsigned i, host;
+
+  if (guest == VR4300_REGISTER_ZERO)
+    return;
+
+  host = GetHostRegister(e, guest, false);
+  EmitRegister(e, X86_MOV, host, HOST_RAX, true);
+
+  for (i = 0; HostRegisters[i] != host; i++);
+  e->dirty[i] = true;
+}
+
+/* ============================================================================
+ *  VR4300DestroyRecompiler: Releases both views of the code buffer.
+ * ========================================================================= */
+void
+VR4300DestroyRecompiler(struct VR4300Recompiler *recompiler) {
+  if (recompiler->buffer != NULL) {
+    munmap(recompiler->buffer, VR4300_RECOMPILER_BUFFER_SIZE);
+    munmap(recompiler->executable, VR4300_RECOMPILER_BUFFER_SIZE);
+  }
+
+  recompiler->buffer = NULL;
+  recompiler->executable = NULL;
+  recompiler->enabled = false;
+}
+
+/* ============================================================================
+ *  VR4300RecompileBlock: Compiles each run of recompilable instructions in
+ *  a freshly built block into a function operating on the register file.
+ * ========================================================================= */
+void
+VR4300RecompileBlock(struct VR4300 *vr4300, struct VR4300Block *block) {
+  struct VR4300Recompiler *recompiler = &vr4300->recompiler;
+  unsigned i, j, k;
+
+  /* Start over once the buffer fills up. */
+  if (recompiler->used + VR4300_RECOMPILER_BLOCK_BYTES >
+    VR4300_RECOMPILER_BUFFER_SIZE) {
+    VR4300FlushBlocks(&vr4300->blockCache);
+    recompiler->used = 0;
+  }
+
+  for (i = 0; i < block->length; i = j) {
+    union {
+      uint8_t *code;
+      VR4300NativeCode native;
+    } function;
+
+    struct Emitter e;
+
+    /* Leave runs that came from static code alone. */
+    if (block->code[i].native != NULL) {
+      j = i + block->code[i].nativeLength;
+      continue;
+    }
+
+    for (j = i; j < block->length && block->code[j].native == NULL &&
+      CanRecompile(block->code + j); j++);
+
+    if (j - i < VR4300_RECOMPILER_MIN_RUN) {
+      j = i + 1;
+      continue;
+    }
+
+    memset(&e, 0, sizeof(e));
+    e.start = e.code = recompiler->buffer + recompiler->used;
+
+    for (k = i; k < j; k++)
+      Compile(&e, block->code + k);
+
+    FlushRegisters(&e);
+
+    /* Same offset, in the view that can run it. */
+    function.code = recompiler->executable + (e.start - recompiler->buffer);
+    block->code[i].native = function.native;
+    block->code[i].nativeLength = j - i;
+    recompiler->used += e.code - e.start;
+  }
+}
+
+/* ============================================================================
+ *  VR4300SetRecompiler: Turns the recompiler on or off. Returns false if it
+ *  couldn't be enabled (unsupported host, no executable memory).
+ * ========================================================================= */
+bool
+VR4300SetRecompiler(struct VR4300 *vr4300, bool enabled) {
+  struct VR4300Recompiler *recompiler = &vr4300->recompiler;
+
+  if (enabled && recompiler->buffer == NULL && !MapBuffer(recompiler)) {
+    debug("Failed to allocate executable memory.");
+    return false;
+  }
+
+  /* Blocks hold pointers into the code buffer. */
+  recompiler->enabled = enabled;
+  VR4300FlushBlocks(&vr4300->blockCache);
+  return true;
+}
+
+#else
+void
+VR4300DestroyRecompiler(struct VR4300Recompiler *recompiler) {
+  recompiler->enabled = false;
+}
+
+void
+VR4300RecompileBlock(struct VR4300 *unused(vr4300),
+  struct VR4300Block *unused(block)) {
+}
+
+bool
+VR4300SetRecompiler(struct VR4300 *unused(vr4300), bool enabled) {
+  return !enabled;
+}
+#endif
+
+/* ============================================================================
+ *  VR4300InitRecompiler: Initializes the recompiler. It starts out disabled;
+ *  see VR4300SetRecompiler.
+ * ========================================================================= */
+void
+VR4300InitRecompiler(struct VR4300Recompiler *recompiler) {
+  debug("Initializing Recompiler.");
+  memset(recompiler, 0, sizeof(*recompiler));
+}
+
@@ -0,0 +1,46 @@
+/* ============================================================================
+ *  Recompiler.h: x86-64 recompiler for straight-line integer code.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__RECOMPILER_H__
+#define __VR4300__RECOMPILER_H__
+#include "Common.h"
+#include "BlockCache.h"
+
+/* The emitter only knows how to speak x86-64 SysV. */
+#if defined(USE_RECOMPILER) && \
+  (!defined(__x86_64__) || !defined(__linux__))
+#undef USE_RECOMPILER
+#endif
+
+/* Size of the executable code buffer. */
+#define VR4300_RECOMPILER_BUFFER_SIZE (4 << 20)
+
+/* Shortest run of instructions worth calling out to. */
+#define VR4300_RECOMPILER_MIN_RUN 2
+
+/* The buffer is mapped twice: the emitter writes through one view, and */
+/* code runs from the other, so no page is writable and executable. */
+struct VR4300Recompiler {
+  uint8_t *buffer;
+  uint8_t *executable;
+  uint32_t used;
+
+  bool enabled;
+};
+
+struct VR4300;
+
+void VR4300InitRecompiler(struct VR4300Recompiler *);
+void VR4300DestroyRecompiler(struct VR4300Recompiler *);
+void VR4300RecompileBlock(struct VR4300 *, struct VR4300Block *);
+bool VR4300SetRecompiler(struct VR4300 *, bool);
+
+#endif
+
@@ -89,7 +89,7 @@ Region* GetRegionInfo(const struct VR4300 *vr4300, uint64_t address) {
     }
 
     /* sseg. */
-    if ((lower - 0xC0000000) > 0x20000000)
+    if ((lower - 0xC0000000) < 0x20000000)
       return &SSEG;
 
     return NULL;
@@ -114,3 +114,31 @@ Region* GetRegionInfo(const struct VR4300 *vr4300, uint64_t address) {
   return NULL;
 }
 
+/* ============================================================================
+ *  VR4300UpdateRegionMap: Resolves the region of every segment of the 32-bit
+ *  address space for the current mode. Resolution only depends on which
+ *  segment an address is in, so one address from each is enough. Also
+ *  works out which specialization of the stages the mode can use.
+ * ========================================================================= */
+void
+VR4300UpdateRegionMap(struct VR4300RegionMap *map,
+  const struct VR4300 *vr4300) {
+  const struct VR4300CP0 *cp0 = &vr4300->cp0;
+  unsigned i;
+
+  for (i = 0; i < VR4300_REGION_SEGMENTS; i++) {
+    uint64_t address = (uint64_t) (int64_t) (int32_t) (i << 29);
+    map->segments[i] = GetRegionInfo(vr4300, address);
+  }
+
+  if (cp0->regs.status.kx || cp0->regs.status.sx || cp0->regs.status.ux)
+    map->mode = VR4300_MODE_64BIT;
+
+  else if (cp0->regs.status.erl || cp0->regs.status.exl ||
+    cp0->regs.status.ksu == 0)
+    map->mode = VR4300_MODE_KERNEL32;
+
+  else
+    map->mode = VR4300_MODE_USER32;
+}
+
@@ -21,8 +21,62 @@ struct RegionInfo {
   bool mapped;
 };
 
+/* The region of each 512MiB segment of the sign-extended 32-bit address */
+/* space, for the current mode; rebuilt whenever the Status mode changes. */
+#define VR4300_REGION_SEGMENTS 8
+
+/* Addressing modes that the IC, RF and DC stages are specialized for. */
+enum VR4300AddressMode {
+  VR4300_MODE_KERNEL32,   /* Kernel, with KX, SX and UX clear. */
+  VR4300_MODE_USER32,     /* Supervisor or user, with KX, SX and UX clear. */
+  VR4300_MODE_64BIT,      /* Anything; resolves addresses the long way. */
+  NUM_VR4300_ADDRESS_MODES
+};
+
+struct VR4300RegionMap {
+  const struct RegionInfo *segments[VR4300_REGION_SEGMENTS];
+  enum VR4300AddressMode mode;
+};
+
+/* ============================================================================
+ *  The IC, RF and DC stages are written once against an addressing mode.
+ *  C++ builds instantiate them for each mode, and VR4300Run switches
+ *  between them whenever the mode changes; the exported, non-template
+ *  stages are the VR4300_MODE_64BIT ones. C builds only have those.
+ * ========================================================================= */
+#ifdef __cplusplus
+#define VR4300_MODE_TEMPLATE template <enum VR4300AddressMode Mode>
+#define VR4300_MODE(name) name<Mode>
+#define VR4300_THIS_MODE Mode
+#else
+#define VR4300_MODE_TEMPLATE
+#define VR4300_MODE(name) name
+#define VR4300_THIS_MODE VR4300_MODE_64BIT
+#endif
+
+/* ============================================================================
+ *  VR4300RegionCached: Returns true if accesses to the region are cached.
+ *  Everything that supervisor and user modes can reach is.
+ * ========================================================================= */
+static inline bool
+VR4300RegionCached(enum VR4300AddressMode mode,
+  const struct RegionInfo *region) {
+  return mode == VR4300_MODE_USER32 || region->cached;
+}
+
+/* ============================================================================
+ *  VR4300RegionMapped: Returns true if the region is mapped by the TLB.
+ *  Everything that supervisor and user modes can reach is.
+ * ========================================================================= */
+static inline bool
+VR4300RegionMapped(enum VR4300AddressMode mode,
+  const struct RegionInfo *region) {
+  return mode == VR4300_MODE_USER32 || region->mapped;
+}
+
 const struct RegionInfo* GetDefaultRegion(void);
 const struct RegionInfo* GetRegionInfo(const struct VR4300 *, uint64_t);
+void VR4300UpdateRegionMap(struct VR4300RegionMap *, const struct VR4300 *);
 
 #endif
 
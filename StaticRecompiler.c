@@ -0,0 +1,521 @@
+/* ============================================================================
+ *  StaticRecompiler.c: Ahead-of-time recompiler (guest code to C).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "BlockCache.h"
+#include "CPU.h"
+#include "Decoder.h"
+#include "Opcodes.h"
+#include "Recompiler.h"
+#include "StaticRecompiler.h"
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#ifdef __unix__
+#include <dlfcn.h>
+#endif
+
+/* Per-word flags used while discovering code. */
+#define STATIC_CODE_VISITED (1 << 0)
+#define STATIC_CODE_LEADER (1 << 1)
+
+static void DiscoverCode(const uint8_t *, uint32_t, uint32_t,
+  const uint32_t *, unsigned, uint8_t *);
+static const char *Operand(char *, unsigned);
+static uint32_t ReadImageWord(const uint8_t *, uint32_t);
+static bool TranslateInstruction(char *, size_t, uint32_t);
+
+/* ============================================================================
+ *  DiscoverCode: Walks the control flow from each entry point, marking the
+ *  words that are reachable and the ones that start a basic block.
+ * ========================================================================= */
+static void
+DiscoverCode(const uint8_t *image, uint32_t size, uint32_t base,
+  const uint32_t *entries, unsigned numEntries, uint8_t *flags) {
+  uint32_t numWords = size >> 2, *queue, queued = 0;
+  unsigned i;
+
+  if ((queue = (uint32_t*) malloc(sizeof(*queue) * numWords)) == NULL)
+    return;
+
+  /* Entry points may be given as KSEG0/KSEG1 addresses. */
+  for (i = 0; i < numEntries; i++) {
+    uint32_t word = ((entries[i] & 0x1FFFFFFF) - base) >> 2;
+
+    if (word < numWords && !(flags[word] & STATIC_CODE_LEADER)) {
+      flags[word] |= STATIC_CODE_LEADER;
+      queue[queued++] = word;
+    }
+  }
+
+  while (queued) {
+    uint32_t word = queue[--queued];
+
+    for (; word < numWords && !(flags[word] & STATIC_CODE_VISITED); word++) {
+      uint32_t iw = ReadImageWord(image, word << 2);
+      const struct VR4300Opcode *opcode = VR4300DecodeInstruction(iw);
+      uint32_t targets[2], numTargets = 0, target;
+      bool stop = false;
+
+      flags[word] |= STATIC_CODE_VISITED;
+
+      /* Don't run off into data or past an ERET. */
+      if (opcode->id == VR4300_OPCODE_INV || iw == 0x42000018)
+        break;
+
+      if (!(opcode->flags & OPCODE_INFO_BRANCH))
+        continue;
+
+      switch (opcode->id) {
+        case VR4300_OPCODE_B:
+          stop = true;
+          targets[numTargets++] = base + (word << 2) + 4 +
+            ((int32_t) (int16_t) iw << 2);
+          break;
+
+        case VR4300_OPCODE_J:
+          stop = true;
+          /* Fallthrough. */
+
+        case VR4300_OPCODE_JAL:
+          targets[numTargets++] = (iw & 0x3FFFFFF) << 2;
+          break;
+
+        case VR4300_OPCODE_JR:
+          stop = true;
+          break;
+
+        case VR4300_OPCODE_JALR:
+          break;
+
+        default:
+          targets[numTargets++] = base + (word << 2) + 4 +
+            ((int32_t) (int16_t) iw << 2);
+          break;
+      }
+
+      /* Returns (and not-taken branches) resume after the delay slot. */
+      if (!stop)
+        targets[numTargets++] = base + (word << 2) + 8;
+
+      for (i = 0; i < numTargets; i++) {
+        target = (targets[i] - base) >> 2;
+
+        if (target < numWords && !(flags[target] & STATIC_CODE_LEADER)) {
+          flags[target] |= STATIC_CODE_LEADER;
+          queue[queued++] = target;
+        }
+      }
+
+      /* Visit the delay slot, then follow the targets instead. */
+      if (word + 1 < numWords)
+        flags[word + 1] |= STATIC_CODE_VISITED;
+
+      break;
+    }
+  }
+
+  free(queue);
+}
+
+/* ============================================================================
+ *  Operand: Formats a register operand. $zero is never read from the
+ *  register file, as the interpreter may leave junk in it.
+ * ========================================================================= */
+static const char *
+Operand(char *buffer, unsigned reg) {
+  if (reg == VR4300_REGISTER_ZERO)
+    return "0";
+
+  sprintf(buffer, "r[%u]", reg);
+  return buffer;
+}
+
+/* ============================================================================
+ *  ReadImageWord: Reads a (big-endian) word from the code image.
+ * ========================================================================= */
+static uint32_t
+ReadImageWord(const uint8_t *image, uint32_t offset) {
+  return (uint32_t) image[offset] << 24 | image[offset + 1] << 16 |
+    image[offset + 2] << 8 | image[offset + 3];
+}
+
+/* ============================================================================
+ *  TranslateInstruction: Writes a C statement with the same semantics as
+ *  the instruction's handler in EXStage.c. Returns false if the instruction
+ *  has side effects beyond the register file (or isn't handled yet).
+ * ========================================================================= */
+static bool
+TranslateInstruction(char *buffer, size_t size, uint32_t iw) {
+  const struct VR4300Opcode *opcode = VR4300DecodeInstruction(iw);
+  unsigned rt = GET_RT(iw), rd = GET_RD(iw);
+  unsigned sa = iw >> 6 & 0x1F;
+  int simm = (int16_t) iw;
+  unsigned uimm = (uint16_t) iw;
+  char expression[96], sbuf[8], tbuf[8];
+  const char *rs = Operand(sbuf, GET_RS(iw));
+  const char *rtv = Operand(tbuf, rt);
+  unsigned dest = rd;
+
+#define EMIT(...) snprintf(expression, sizeof(expression), __VA_ARGS__)
+#define SEXT32 "(uint64_t) (int64_t) (int32_t) "
+
+  switch (opcode->id) {
+    case VR4300_OPCODE_ADD_ADDU_SUB_SUBU:
+      EMIT(SEXT32 "(uint32_t) (%s %c %s)", rs, iw >> 1 & 0x1 ? '-' : '+', rtv);
+      break;
+
+    case VR4300_OPCODE_ADDI_SUBI_ADDIU_SUBIU:
+      EMIT(SEXT32 "(uint32_t) (%s + (uint64_t) %dLL)", rs, simm);
+      dest = rt;
+      break;
+
+    case VR4300_OPCODE_AND: EMIT("%s & %s", rs, rtv); break;
+    case VR4300_OPCODE_OR: EMIT("%s | %s", rs, rtv); break;
+    case VR4300_OPCODE_XOR: EMIT("%s ^ %s", rs, rtv); break;
+    case VR4300_OPCODE_NOR: EMIT("~(%s | %s)", rs, rtv); break;
+
+    case VR4300_OPCODE_ANDI: EMIT("%s & 0x%XU", rs, uimm); dest = rt; break;
+    case VR4300_OPCODE_ORI: EMIT("%s | 0x%XU", rs, uimm); dest = rt; break;
+    case VR4300_OPCODE_XORI: EMIT("%s ^ 0x%XU", rs, uimm); dest = rt; break;
+
+    case VR4300_OPCODE_DADD:
+    case VR4300_OPCODE_DADDU:
+      EMIT("(uint64_t) %s + %s", rs, rtv);
+      break;
+
+    case VR4300_OPCODE_DSUB:
+    case VR4300_OPCODE_DSUBU:
+      EMIT("(uint64_t) %s - %s", rs, rtv);
+      break;
+
+    case VR4300_OPCODE_DADDI:
+    case VR4300_OPCODE_DADDIU:
+      EMIT("%s + (uint64_t) %dLL", rs, simm);
+      dest = rt;
+      break;
+
+    case VR4300_OPCODE_LUI:
+      EMIT(SEXT32 "0x%XU", (uint32_t) iw << 16);
+      dest = rt;
+      break;
+
+    case VR4300_OPCODE_LI:
+      EMIT("(uint64_t) %dLL", simm);
+      dest = rt;
+      break;
+
+    case VR4300_OPCODE_MOVE: EMIT("%s", rs); break;
+    case VR4300_OPCODE_NOP: dest = VR4300_REGISTER_ZERO; break;
+
+    case VR4300_OPCODE_SLT:
+      EMIT("(int64_t) %s < (int64_t) %s", rs, rtv);
+      break;
+
+    case VR4300_OPCODE_SLTU:
+      EMIT("(uint64_t) %s < (uint64_t) %s", rs, rtv);
+      break;
+
+    case VR4300_OPCODE_SLTI:
+      EMIT("(int64_t) %s < %dLL", rs, simm);
+      dest = rt;
+      break;
+
+    case VR4300_OPCODE_SLTIU:
+      EMIT("(uint64_t) %s < (uint64_t) %dLL", rs, simm);
+      dest = rt;
+      break;
+
+    case VR4300_OPCODE_SLL:
+      EMIT(SEXT32 "((uint32_t) %s << %u)", rtv, sa);
+      break;
+
+    case VR4300_OPCODE_SRL:
+      EMIT(SEXT32 "((uint32_t) %s >> %u)", rtv, sa);
+      break;
+
+    case VR4300_OPCODE_SRA:
+      EMIT(SEXT32 "((int32_t) %s >> %u)", rtv, sa);
+      break;
+
+    case VR4300_OPCODE_SLLV:
+      EMIT(SEXT32 "((uint32_t) %s << (%s & 0x1F))", rtv, rs);
+      break;
+
+    case VR4300_OPCODE_SRLV:
+      EMIT(SEXT32 "((uint32_t) %s >> (%s & 0x1F))", rtv, rs);
+      break;
+
+    case VR4300_OPCODE_SRAV:
+      EMIT(SEXT32 "((int32_t) %s >> (%s & 0x1F))", rtv, rs);
+      break;
+
+    case VR4300_OPCODE_DSLL: EMIT("(uint64_t) %s << %u", rtv, sa); break;
+    case VR4300_OPCODE_DSLL32: EMIT("(uint64_t) %s << %u", rtv, sa + 32); break;
+    case VR4300_OPCODE_DSRL: EMIT("(uint64_t) %s >> %u", rtv, sa); break;
+    case VR4300_OPCODE_DSRL32: EMIT("(uint64_t) %s >> %u", rtv, sa + 32); break;
+
+    case VR4300_OPCODE_DSRA:
+      EMIT("(uint64_t) ((int64_t) %s >> %u)", rtv, sa);
+      break;
+
+    case VR4300_OPCODE_DSRA32:
+      EMIT("(uint64_t) ((int64_t) %s >> %u)", rtv, sa + 32);
+      break;
+
+    case VR4300_OPCODE_DSLLV:
+      EMIT("(uint64_t) %s << (%s & 0x3F)", rtv, rs);
+      break;
+
+    case VR4300_OPCODE_DSRLV:
+      EMIT("(uint64_t) %s >> (%s & 0x3F)", rtv, rs);
+      break;
+
+    case VR4300_OPCODE_DSRAV:
+      EMIT("(uint64_t) ((int64_t) %s >> (%s & 0x3F))", rtv, rs);
+      break;
+
+    case VR4300_OPCODE_MFHI: EMIT("r[%u]", VR4300_REGISTER_HI); break;
+    case VR4300_OPCODE_MFLO: EMIT("r[%u]", VR4300_REGISTER_LO); break;
+
+    case VR4300_OPCODE_MTHI:
+      EMIT("%s", rs);
+      dest = VR4300_REGISTER_HI;
+      break;
+
+    case VR4300_OPCODE_MTLO:
+      EMIT("%s", rs);
+      dest = VR4300_REGISTER_LO;
+      break;
+
+    default:
+      return false;
+  }
+
+#undef SEXT32
+#undef EMIT
+
+  /* Writes to $zero are dropped; the caller emits them as no-ops. */
+  if (dest == VR4300_REGISTER_ZERO)
+    buffer[0] = '\0';
+
+  else
+    snprintf(buffer, size, "r[%u] = %s", dest, expression);
+
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300AttachStaticCode: Hooks up any runs from the loaded static code to
+ *  a freshly built block, as long as the guest code still matches.
+ * ========================================================================= */
+void
+VR4300AttachStaticCode(struct VR4300 *vr4300, struct VR4300Block *block) {
+  const struct VR4300StaticCode *staticCode = &vr4300->staticCode;
+  unsigned i, k;
+
+  for (i = 0; i < block->length; i++) {
+    uint32_t paddr = block->paddr + (i << 2);
+    unsigned low = 0, high = staticCode->count;
+    const struct VR4300StaticRun *run = NULL;
+
+    while (low < high) {
+      unsigned middle = (low + high) >> 1;
+
+      if (staticCode->runs[middle].paddr < paddr)
+        low = middle + 1;
+
+      else if (staticCode->runs[middle].paddr > paddr)
+        high = middle;
+
+      else {
+        run = staticCode->runs + middle;
+        break;
+      }
+    }
+
+    if (run == NULL || i + run->length > block->length)
+      continue;
+
+    for (k = 0; k < run->length; k++) {
+      if (block->code[i + k].iw != run->code[k])
+        break;
+    }
+
+    if (k == run->length) {
+      block->code[i].native = run->function;
+      block->code[i].nativeLength = run->length;
+      i += run->length - 1;
+    }
+  }
+}
+
+/* ============================================================================
+ *  VR4300InitStaticCode: Initializes the static code (none is loaded).
+ * ========================================================================= */
+void
+VR4300InitStaticCode(struct VR4300StaticCode *staticCode) {
+  memset(staticCode, 0, sizeof(*staticCode));
+}
+
+/* ============================================================================
+ *  VR4300LoadStaticCode: Loads a shared object written out by the static
+ *  recompiler. Its runs are used by VR4300RunCached from then on.
+ * ========================================================================= */
+bool
+VR4300LoadStaticCode(struct VR4300 *vr4300, const char *path) {
+#ifdef __unix__
+  struct VR4300StaticCode *staticCode = &vr4300->staticCode;
+  const unsigned *count;
+  void *handle, *runs;
+
+  VR4300UnloadStaticCode(vr4300);
+
+  if ((handle = dlopen(path, RTLD_NOW | RTLD_LOCAL)) == NULL) {
+    debugarg("Failed to load static code: %s.", dlerror());
+    return false;
+  }
+
+  if ((runs = dlsym(handle, "VR4300StaticRuns")) == NULL ||
+    (count = (const unsigned*) dlsym(handle, "VR4300NumStaticRuns")) == NULL) {
+    debug("Static code is missing its run table.");
+    dlclose(handle);
+    return false;
+  }
+
+  staticCode->handle = handle;
+  staticCode->runs = (const struct VR4300StaticRun*) runs;
+  staticCode->count = *count;
+
+  VR4300FlushBlocks(&vr4300->blockCache);
+  return true;
+#else
+  debugarg("Static code isn't supported on this host: %s.", path);
+  return vr4300 == NULL;
+#endif
+}
+
+/* ============================================================================
+ *  VR4300UnloadStaticCode: Unloads the static code, if any is loaded.
+ * ========================================================================= */
+void
+VR4300UnloadStaticCode(struct VR4300 *vr4300) {
+  struct VR4300StaticCode *staticCode = &vr4300->staticCode;
+
+  if (staticCode->handle == NULL)
+    return;
+
+  /* Blocks hold pointers into the shared object. */
+  VR4300FlushBlocks(&vr4300->blockCache);
+
+#ifdef __unix__
+  dlclose(staticCode->handle);
+#endif
+
+  memset(staticCode, 0, sizeof(*staticCode));
+}
+
+/* ============================================================================
+ *  VR4300WriteStaticCode: Discovers the code reachable from a list of entry
+ *  points in a raw (big-endian) image loaded at the given physical address,
+ *  and writes out C for each run of instructions that only touch the
+ *  register file. Returns the number of runs written.
+ * ========================================================================= */
+unsigned
+VR4300WriteStaticCode(FILE *out, const uint8_t *image, uint32_t size,
+  uint32_t base, const uint32_t *entries, unsigned numEntries) {
+  uint32_t numWords = size >> 2, word, *runs;
+  unsigned numRuns = 0, i;
+  char statement[128];
+  uint8_t *flags;
+
+  if ((flags = (uint8_t*) calloc(numWords + 1, 1)) == NULL ||
+    (runs = (uint32_t*) malloc(sizeof(*runs) * (numWords + 1))) == NULL) {
+    free(flags);
+    return 0;
+  }
+
+  DiscoverCode(image, size, base, entries, numEntries, flags);
+
+  fprintf(out,
+    "/* Generated by the VR4300 static recompiler; do not edit. */\n"
+    "#include <stdint.h>\n\n"
+    "struct VR4300StaticRun {\n"
+    "  uint32_t paddr;\n"
+    "  uint32_t length;\n\n"
+    "  const uint32_t *code;\n"
+    "  void (*function)(uint64_t *);\n"
+    "};\n\n");
+
+  /* Runs stop at block leaders, page boundaries and the block size limit. */
+  for (word = 0; word < numWords; ) {
+    uint32_t start = word;
+
+    while (word < numWords && (flags[word] & STATIC_CODE_VISITED) &&
+      TranslateInstruction(statement, sizeof(statement),
+      ReadImageWord(image, word << 2))) {
+      word++;
+
+      if (word - start == VR4300_BLOCK_MAX_LENGTH ||
+        (flags[word] & STATIC_CODE_LEADER) ||
+        ((base + (word << 2)) & 0xFFF) == 0)
+        break;
+    }
+
+    if (word - start < VR4300_RECOMPILER_MIN_RUN) {
+      word = start + 1;
+      continue;
+    }
+
+    fprintf(out, "static const uint32_t Code%08X[] = {",
+      base + (start << 2));
+
+    for (i = start; i < word; i++)
+      fprintf(out, "%s0x%08X", i == start ? "" : ", ",
+        ReadImageWord(image, i << 2));
+
+    fprintf(out, "};\n\nstatic void Run%08X(uint64_t *r) {\n",
+      base + (start << 2));
+
+    for (i = start; i < word; i++) {
+      TranslateInstruction(statement, sizeof(statement),
+        ReadImageWord(image, i << 2));
+
+      if (statement[0] != '\0')
+        fprintf(out, "  %s;\n", statement);
+    }
+
+    fprintf(out, "}\n\n");
+    runs[numRuns++] = start;
+  }
+
+  fprintf(out, "const struct VR4300StaticRun VR4300StaticRuns[] = {\n");
+
+  for (i = 0; i < numRuns; i++) {
+    uint32_t paddr = base + (runs[i] << 2);
+
+    fprintf(out, "  {0x%08X, sizeof(Code%08X) / sizeof(uint32_t), "
+      "Code%08X, Run%08X},\n", paddr, paddr, paddr, paddr);
+  }
+
+  fprintf(out, "  {0, 0, 0, 0}\n};\n\n"
+    "const unsigned VR4300NumStaticRuns = %u;\n", numRuns);
+
+  free(runs);
+  free(flags);
+  return numRuns;
+}
+
@@ -0,0 +1,49 @@
+/* ============================================================================
+ *  StaticRecompiler.h: Ahead-of-time recompiler (guest code to C).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__STATICRECOMPILER_H__
+#define __VR4300__STATICRECOMPILER_H__
+#include "Common.h"
+#include "BlockCache.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#else
+#include <stdio.h>
+#endif
+
+/* Must match the definition written out by VR4300WriteStaticCode. */
+struct VR4300StaticRun {
+  uint32_t paddr;
+  uint32_t length;
+
+  /* The words the run was built from, to catch self-modified code. */
+  const uint32_t *code;
+  VR4300NativeCode function;
+};
+
+struct VR4300StaticCode {
+  void *handle;
+
+  const struct VR4300StaticRun *runs;
+  unsigned count;
+};
+
+struct VR4300;
+
+void VR4300AttachStaticCode(struct VR4300 *, struct VR4300Block *);
+void VR4300InitStaticCode(struct VR4300StaticCode *);
+bool VR4300LoadStaticCode(struct VR4300 *, const char *);
+void VR4300UnloadStaticCode(struct VR4300 *);
+unsigned VR4300WriteStaticCode(FILE *, const uint8_t *, uint32_t, uint32_t,
+  const uint32_t *, unsigned);
+
+#endif
+
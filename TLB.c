@@ -11,8 +11,10 @@
 #include "Common.h"
 #include "CP0.h"
 #include "CPU.h"
+#include "IdleLoop.h"
 #include "Pipeline.h"
 #include "TLB.h"
+#include "TLBMatch.h"
 #include "TLBTree.h"
 
 #ifdef __cplusplus
@@ -25,13 +27,87 @@
 
 void VR4300ERET(struct VR4300 *);
 
+static VR4300TLBEntry* GetEntry(struct VR4300TLB *, unsigned);
+static const VR4300TLBEntry* LookupEntry(const struct VR4300TLB *,
+  uint8_t, uint64_t);
+static bool LookupPage(const struct VR4300TLB *, uint8_t, uint64_t,
+  uint32_t *, uint32_t *);
+
+/* ============================================================================
+ *  GetEntry: Returns an entry by index.
+ * ========================================================================= */
+static VR4300TLBEntry*
+GetEntry(struct VR4300TLB *tlb, unsigned index) {
+#ifdef USE_TLB_MATCH
+  return tlb->tlbMatch.entries + index;
+#else
+  return tlb->tlbTree.entries + index;
+#endif
+}
+
+/* ============================================================================
+ *  LookupEntry: Returns the entry that maps a virtual address, if any.
+ * ========================================================================= */
+static const VR4300TLBEntry*
+LookupEntry(const struct VR4300TLB *tlb, uint8_t asid, uint64_t vaddr) {
+#ifdef USE_TLB_MATCH
+  return TLBMatchLookup(&tlb->tlbMatch, asid, vaddr);
+#else
+  return TLBTreeLookup(&tlb->tlbTree, asid, vaddr);
+#endif
+}
+
+/* ============================================================================
+ *  LookupPage: Finds the (even or odd) page that maps a virtual address.
+ *  Returns its frame address and offset mask, if there is one.
+ * ========================================================================= */
+static bool
+LookupPage(const struct VR4300TLB *tlb, uint8_t asid, uint64_t vaddr,
+  uint32_t *pfn, uint32_t *mask) {
+  const struct EntryLo *loEntry;
+  const VR4300TLBEntry* node;
+  uint64_t pageEndAddr;
+
+  if ((node = LookupEntry(tlb, asid, vaddr)) == NULL)
+    return false;
+
+  *mask = (node->pageMask << 12) | 0xFFF;
+  pageEndAddr = (node->tlbEntryHi.vpn2 << 13) + (*mask +1);
+
+  loEntry = (vaddr >= pageEndAddr)
+    ? &node->tlbEntryLo1
+    : &node->tlbEntryLo0;
+
+  *pfn = loEntry->pfn << 12;
+  return true;
+}
+
+/* ============================================================================
+ *  VR4300FlushMicroTLBs: Invalidates both micro-TLBs. Called whenever an
+ *  entry is written, or the ASID or operating mode changes.
+ * ========================================================================= */
+void
+VR4300FlushMicroTLBs(struct VR4300TLB *tlb) {
+  VR4300FlushMicroTLB(&tlb->itlb);
+  VR4300FlushMicroTLB(&tlb->dtlb);
+}
+
 /* ============================================================================
  *  InitVR4300: Initializes the VR4300.
  * ========================================================================= */
 void
 VR4300InitTLB(struct VR4300TLB *tlb) {
   debug("Initializing TLB.");
+
+#ifdef USE_TLB_MATCH
+  InitTLBMatch(&tlb->tlbMatch);
+#else
   InitTLBTree(&tlb->tlbTree);
+#endif
+
+  memset(&tlb->itlb, 0, sizeof(tlb->itlb));
+  memset(&tlb->dtlb, 0, sizeof(tlb->dtlb));
+  VR4300FlushMicroTLBs(tlb);
 }
 
 /* ==========================================================================
@@ -51,14 +127,14 @@ VR4300TLBP(struct VR4300 *vr4300) {
   vr4300->cp0.regs.index.probe = 0;
 
   /* Try to grab the node with the page start address. */
-  const struct TLBNode* node = TLBTreeLookup(
-    &vr4300->tlb.tlbTree, vr4300->cp0.regs.entryHi.asid,
+  const VR4300TLBEntry* node = LookupEntry(
+    &vr4300->tlb, vr4300->cp0.regs.entryHi.asid,
     (uint64_t) vr4300->cp0.regs.entryHi.region << 62 |
     (uint64_t) vr4300->cp0.regs.entryHi.vpn2 << 13);
 
   if (node != NULL) {
     vr4300->cp0.regs.index.probe = 1;
-    vr4300->cp0.regs.index.index = node - vr4300->tlb.tlbTree.entries;
+    vr4300->cp0.regs.index.index = node - GetEntry(&vr4300->tlb, 0);
   }
 }
 
@@ -70,7 +146,7 @@ VR4300TLBR(struct VR4300 *vr4300) {
   unsigned idx = vr4300->cp0.regs.index.index;
   struct VR4300CP0* cp0 = &vr4300->cp0;
 
-  const struct TLBNode* node = vr4300->tlb.tlbTree.entries + idx;
+  const VR4300TLBEntry* node = GetEntry(&vr4300->tlb, idx);
 
   memcpy(&cp0->regs.entryLo0, &node->tlbEntryLo0, sizeof(node->tlbEntryLo0));
   memcpy(&cp0->regs.entryLo1, &node->tlbEntryLo1, sizeof(node->tlbEntryLo1));
@@ -90,8 +166,7 @@ VR4300TLBWI(struct VR4300 *vr4300) {
   struct EntryLo *entryLo0 = &vr4300->cp0.regs.entryLo0;
   struct EntryLo *entryLo1 = &vr4300->cp0.regs.entryLo1;
   uint16_t pageMask = vr4300->cp0.regs.pageMask;
-  struct TLBTree *tlbTree = &vr4300->tlb.tlbTree;
-  struct TLBNode *node;
+  VR4300TLBEntry *node;
 
 #ifndef NDEBUG
   debugarg("Mapping TLB Entry: %u", vr4300->cp0.regs.index.index);
@@ -118,22 +193,31 @@ VR4300TLBWI(struct VR4300 *vr4300) {
 #endif
 
   /* Evict the old entry, setup up the new one, insert it. */
-  node = tlbTree->entries + vr4300->cp0.regs.index.index;
+  node = GetEntry(&vr4300->tlb, vr4300->cp0.regs.index.index);
 
-  TLBTreeEvict(tlbTree, node);
+#ifndef USE_TLB_MATCH
+  TLBTreeEvict(&vr4300->tlb.tlbTree, node);
+#endif
   memcpy(&node->tlbEntryLo0, entryLo0, sizeof(*entryLo0));
   memcpy(&node->tlbEntryLo1, entryLo1, sizeof(*entryLo1));
   memcpy(&node->tlbEntryHi,  entryHi,  sizeof(*entryHi));
   node->pageMask = pageMask;
-  TLBTreeInsert(tlbTree, node);
+#ifdef USE_TLB_MATCH
+  TLBMatchUpdate(&vr4300->tlb.tlbMatch, node);
+#else
+  TLBTreeInsert(&vr4300->tlb.tlbTree, node);
+#endif
+  VR4300FlushMicroTLBs(&vr4300->tlb);
+  VR4300IdleLoopSideEffect(vr4300);
 }
 
 /* ==========================================================================
  *  Instruction: TLBWR (Write Random TLB Entry)
  * ========================================================================= */
 void
-VR4300TLBWR(struct VR4300 *unused(vr4300)) {
+VR4300TLBWR(struct VR4300 *vr4300) {
   debug("Unimplemented function: TLBWR.");
+  VR4300FlushMicroTLBs(&vr4300->tlb);
 }
 
 /* ============================================================================
@@ -187,23 +271,32 @@ VR4300TLB(struct VR4300 *vr4300,uint64_t unused(rs), uint64_t unused(rt)) {
  * ========================================================================= */
 bool
 VR4300Translate(struct VR4300 *vr4300, uint64_t vaddr, uint32_t* paddr) {
-  const struct EntryLo *loEntry;
-  const struct TLBNode* node;
-  uint64_t pageEndAddr;
-  uint32_t mask;
+  uint32_t mask, pfn;
 
-  if ((node = TLBTreeLookup(&vr4300->tlb.tlbTree,
-    vr4300->cp0.regs.entryHi.asid, vaddr)) == NULL)
+  if (!LookupPage(&vr4300->tlb,
+    vr4300->cp0.regs.entryHi.asid, vaddr, &pfn, &mask))
     return false;
 
-  mask = (node->pageMask << 12) | 0xFFF;
-  pageEndAddr = (node->tlbEntryHi.vpn2 << 13) + (mask +1);
+  *paddr = pfn | (vaddr & mask);
+  return true;
+}
 
-  loEntry = (vaddr >= pageEndAddr)
-    ? &node->tlbEntryLo1
-    : &node->tlbEntryLo0;
+/* ============================================================================
+ *  VR4300TranslateMiss: Translates a virtual to physical address that the
+ *  given micro-TLB didn't have, and refills the micro-TLB with the page.
+ * ========================================================================= */
+bool
+VR4300TranslateMiss(struct VR4300 *vr4300, struct VR4300MicroTLB *utlb,
+  uint64_t vaddr, uint32_t *paddr) {
+  uint32_t mask, pfn;
+
+  utlb->misses++;
 
-  *paddr = (loEntry->pfn << 12) | (vaddr & mask);
+  if (!LookupPage(&vr4300->tlb,
+    vr4300->cp0.regs.entryHi.asid, vaddr, &pfn, &mask))
+    return false;
+
+  VR4300FillMicroTLB(utlb, vaddr, pfn, mask);
+  *paddr = pfn | (vaddr & mask);
   return true;
 }
-
@@ -11,15 +11,35 @@
 #ifndef __VR4300__TLB_H__
 #define __VR4300__TLB_H__
 #include "Common.h"
-#include "TLB.h"
+#include "MicroTLB.h"
+#include "TLBMatch.h"
 #include "TLBTree.h"
 
+/* Build with -DUSE_TLB_MATCH to match all entries at once (see */
+/* TLBMatch.c), instead of searching the red-black trees. */
+#ifdef USE_TLB_MATCH
+typedef struct TLBMatchEntry VR4300TLBEntry;
+#else
+typedef struct TLBNode VR4300TLBEntry;
+#endif
+
 struct VR4300TLB {
+#ifdef USE_TLB_MATCH
+  struct TLBMatch tlbMatch;
+#else
   struct TLBTree tlbTree;
+#endif
+
+  /* Checked first; see VR4300TranslateCode/Data. */
+  struct VR4300MicroTLB itlb;
+  struct VR4300MicroTLB dtlb;
 };
 
+void VR4300FlushMicroTLBs(struct VR4300TLB *);
 void VR4300InitTLB(struct VR4300TLB *);
 bool VR4300Translate(struct VR4300 *vr4300, uint64_t vaddr, uint32_t* paddr);
+bool VR4300TranslateMiss(struct VR4300 *, struct VR4300MicroTLB *,
+  uint64_t, uint32_t *);
 
 #endif
 
@@ -0,0 +1,143 @@
+/* ============================================================================
+ *  TLBMatch.c: Parallel-match TLB (packed entries, SIMD compares).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "TLBMatch.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(USE_SSE)
+#include <emmintrin.h>
+#endif
+
+static uint32_t MatchEntries(const struct TLBMatch *, uint32_t, uint32_t);
+
+/* ============================================================================
+ *  InitTLBMatch: Initializes the TLB with every entry unused.
+ * ========================================================================= */
+void
+InitTLBMatch(struct TLBMatch *tlb) {
+  memset(tlb, 0, sizeof(*tlb));
+
+  /* No VPN2 has all of the bits set, so these never hit. */
+  memset(tlb->vpn2, 0xFF, sizeof(tlb->vpn2));
+  memset(tlb->vpn2Mask, 0xFF, sizeof(tlb->vpn2Mask));
+}
+
+/* ============================================================================
+ *  MatchEntries: Returns a bitmask of the entries that map a VPN2/ASID.
+ * ========================================================================= */
+static uint32_t
+MatchEntries(const struct TLBMatch *tlb, uint32_t vpn2, uint32_t asid) {
+  uint32_t hits = 0;
+  unsigned i;
+
+#ifdef __AVX2__
+  __m256i vpn2Key = _mm256_set1_epi32(vpn2);
+  __m256i asidKey = _mm256_set1_epi32(asid);
+
+  for (i = 0; i < NUM_TLB_ENTRIES; i += 8) {
+    __m256i vpn2Hit = _mm256_cmpeq_epi32(_mm256_and_si256(vpn2Key,
+      _mm256_loadu_si256((const __m256i*) (tlb->vpn2Mask + i))),
+      _mm256_loadu_si256((const __m256i*) (tlb->vpn2 + i)));
+    __m256i asidHit = _mm256_cmpeq_epi32(_mm256_and_si256(asidKey,
+      _mm256_loadu_si256((const __m256i*) (tlb->asidMask + i))),
+      _mm256_loadu_si256((const __m256i*) (tlb->asid + i)));
+
+    hits |= (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(
+      _mm256_and_si256(vpn2Hit, asidHit))) << i;
+  }
+#elif defined(USE_SSE)
+  __m128i vpn2Key = _mm_set1_epi32(vpn2);
+  __m128i asidKey = _mm_set1_epi32(asid);
+
+  for (i = 0; i < NUM_TLB_ENTRIES; i += 4) {
+    __m128i vpn2Hit = _mm_cmpeq_epi32(_mm_and_si128(vpn2Key,
+      _mm_loadu_si128((const __m128i*) (tlb->vpn2Mask + i))),
+      _mm_loadu_si128((const __m128i*) (tlb->vpn2 + i)));
+    __m128i asidHit = _mm_cmpeq_epi32(_mm_and_si128(asidKey,
+      _mm_loadu_si128((const __m128i*) (tlb->asidMask + i))),
+      _mm_loadu_si128((const __m128i*) (tlb->asid + i)));
+
+    hits |= (uint32_t) _mm_movemask_ps(_mm_castsi128_ps(
+      _mm_and_si128(vpn2Hit, asidHit))) << i;
+  }
+#else
+  for (i = 0; i < NUM_TLB_ENTRIES; i++) {
+    if ((vpn2 & tlb->vpn2Mask[i]) == tlb->vpn2[i] &&
+      (asid & tlb->asidMask[i]) == tlb->asid[i])
+      hits |= 1U << i;
+  }
+#endif
+
+  return hits;
+}
+
+/* ============================================================================
+ *  TLBMatchLookup: Looks up the entry mapping a 64-bit virtual address.
+ *  Like the TLBTree, global entries are preferred over ASID ones.
+ * ========================================================================= */
+const struct TLBMatchEntry*
+TLBMatchLookup(const struct TLBMatch *tlb, uint8_t asid, uint64_t address) {
+  uint32_t vpn2 = ((uint32_t) (address >> 13)) & 0x07FFFFFFU;
+  uint8_t region = (address >> 62) & 0x3;
+  uint32_t hits;
+  unsigned i;
+
+  /* Merge the region into the VPN. */
+  vpn2 |= ((uint32_t) region) << 27;
+
+  if ((hits = MatchEntries(tlb, vpn2, asid)) == 0)
+    return NULL;
+
+  if (hits & tlb->global)
+    hits &= tlb->global;
+
+#ifdef __GNUC__
+  i = __builtin_ctz(hits);
+#else
+  for (i = 0; !(hits & 0x1); hits >>= 1, i++);
+#endif
+
+  return tlb->entries + i;
+}
+
+/* ============================================================================
+ *  TLBMatchUpdate: Refreshes the lane of an entry after it's been written.
+ * ========================================================================= */
+void
+TLBMatchUpdate(struct TLBMatch *tlb, struct TLBMatchEntry *entry) {
+  unsigned i = entry - tlb->entries;
+
+  /* Merge the region into the VPN, as the TLBTree does. */
+  entry->tlbEntryHi.vpn2 |= ((uint32_t) entry->tlbEntryHi.region) << 27;
+
+  tlb->vpn2[i] = entry->tlbEntryHi.vpn2;
+  tlb->vpn2Mask[i] = ~(uint32_t) entry->pageMask;
+
+  if (entry->tlbEntryLo0.global && entry->tlbEntryLo1.global) {
+    tlb->global |= 1U << i;
+    tlb->asid[i] = 0;
+    tlb->asidMask[i] = 0;
+  }
+
+  else {
+    tlb->global &= ~(1U << i);
+    tlb->asid[i] = entry->tlbEntryHi.asid;
+    tlb->asidMask[i] = 0xFF;
+  }
+}
+
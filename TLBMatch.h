@@ -0,0 +1,45 @@
+/* ============================================================================
+ *  TLBMatch.h: Parallel-match TLB (packed entries, SIMD compares).
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__TLBMATCH_H__
+#define __VR4300__TLBMATCH_H__
+#include "Common.h"
+#include "CP0.h"
+#include "TLBTree.h"
+
+/* The same fields as a TLBNode, less the tree. */
+struct TLBMatchEntry {
+  struct EntryLo tlbEntryLo0;
+  struct EntryLo tlbEntryLo1;
+  struct EntryHi tlbEntryHi;
+  uint16_t pageMask;
+};
+
+/* One lane per entry: a VPN2 (with the region folded in) hits an entry */
+/* when (VPN2 & vpn2Mask) == vpn2 and (ASID & asidMask) == asid. Unused */
+/* entries never hit; global ones have both ASID fields cleared. */
+struct TLBMatch {
+  uint32_t vpn2[NUM_TLB_ENTRIES];
+  uint32_t vpn2Mask[NUM_TLB_ENTRIES];
+  uint32_t asid[NUM_TLB_ENTRIES];
+  uint32_t asidMask[NUM_TLB_ENTRIES];
+  uint32_t global;
+
+  struct TLBMatchEntry entries[NUM_TLB_ENTRIES];
+};
+
+void InitTLBMatch(struct TLBMatch *);
+
+const struct TLBMatchEntry* TLBMatchLookup(const struct TLBMatch *,
+  uint8_t, uint64_t);
+void TLBMatchUpdate(struct TLBMatch *, struct TLBMatchEntry *);
+
+#endif
+
@@ -25,11 +25,13 @@
 
 /* Internal functions used to inspect entries of the tree. */
 static bool DoASIDsMatch(const struct TLBNode *, const struct TLBNode *);
-static bool DoEntriesOverlap(const struct TLBNode *, const struct TLBNode *);
 static uint32_t GetEntryEndAddress(const struct TLBNode *);
 static bool IsGlobalEntry(const struct TLBNode *);
+static const struct TLBNode* SearchASIDTree(const struct TLBNode *,
+  const struct TLBNode *, uint8_t, uint32_t);
 static const struct TLBNode* SearchTree(const struct TLBNode *,
   const struct TLBNode *, uint32_t);
+static bool SortsBefore(const struct TLBNode *, const struct TLBNode *);
 
 /* Internal functions used to maintain the state of the tree. */
 static void RotateLeft(struct TLBNode **,
@@ -41,22 +43,6 @@ static void Transplant(struct TLBNode **, const struct TLBNode *,
 static void TLBTreeFixup(struct TLBNode **,
   struct TLBNode *, struct TLBNode *);
 
-/* ============================================================================
- *  DoEntriesOverlap: Determines if two entries have overlapping addresses.
- * ========================================================================= */
-static bool
-DoEntriesOverlap(const struct TLBNode *x, const struct TLBNode *y) {
-  if (GetEntryEndAddress(x) < GetEntryEndAddress(y)) {
-    if (GetEntryEndAddress(x) >= y->tlbEntryHi.vpn2)
-      return false;
-  }
-
-  else if (x->tlbEntryHi.vpn2 <= GetEntryEndAddress(y))
-    return true;
-
-  return false;
-}
-
 /* ============================================================================
  *  DoASIDsMatch: Determines if two entries have matching ASID values.
  * ========================================================================= */
@@ -150,6 +136,30 @@ RotateRight(struct TLBNode **root,
   n->parent = y;
 }
 
+/* ============================================================================
+ *  SearchASIDTree: Search the ASID tree to see if any of the entries for an
+ *  ASID maps a VPN. That tree is ordered by ASID first (see SortsBefore).
+ * ========================================================================= */
+static const struct TLBNode*
+SearchASIDTree(const struct TLBNode *node,
+  const struct TLBNode *nil, uint8_t asid, uint32_t vpn2) {
+
+  while (node != nil) {
+    if (asid != node->tlbEntryHi.asid)
+      node = (asid < node->tlbEntryHi.asid)
+        ? node->left : node->right;
+
+    else if (node->tlbEntryHi.vpn2 == (~node->pageMask & vpn2))
+      return node;
+
+    else
+      node = (vpn2 < node->tlbEntryHi.vpn2)
+        ? node->left : node->right;
+  }
+
+  return NULL;
+}
+
 /* ============================================================================
  *  SearchTree: Search a subtree to see if any of its entries maps a VPN.
  * ========================================================================= */
@@ -169,6 +179,18 @@ SearchTree(const struct TLBNode *node,
   return NULL;
 }
 
+/* ============================================================================
+ *  SortsBefore: Determines if x goes to the left of y in their tree. Global
+ *  entries are ordered by address; ASID ones by ASID, then by address.
+ * ========================================================================= */
+static bool
+SortsBefore(const struct TLBNode *x, const struct TLBNode *y) {
+  if (!IsGlobalEntry(x) && !DoASIDsMatch(x, y))
+    return x->tlbEntryHi.asid < y->tlbEntryHi.asid;
+
+  return GetEntryEndAddress(x) < GetEntryEndAddress(y);
+}
+
 /* ============================================================================
  *  TLBTreeEvict: Removes a TLB entry from the TLBTree.
  * ========================================================================= */
@@ -406,50 +428,19 @@ TLBTreeInsert(struct TLBTree *tree, struct TLBNode *node) {
 
   /* Merge the region into the VPN to cut down on lookup time. */
   node->tlbEntryHi.vpn2 |= ((uint32_t) node->tlbEntryHi.region) << 27;
-  const uint32_t entryEndAddress = GetEntryEndAddress(node);
 
   /* Walk down the tree. */
-  if (!IsGlobalEntry(node)) {
-    while (check != nil && DoASIDsMatch(node, check)) {
-      cur = check;
-
-      check = (node->tlbEntryHi.asid < check->tlbEntryHi.asid)
-        ? check->left : check->right;
-    }
-  }
-
   while (check != nil) {
     cur = check;
 
-    check = (entryEndAddress < GetEntryEndAddress(check))
+    check = SortsBefore(node, check)
       ? check->left : check->right;
   }
 
-  /* Check for overlaps. */
-  if (!IsGlobalEntry(node)) {
-    struct TLBNode *globalCheck = tree->globalEntryRoot;
-    const struct TLBNode *globalCur = &tree->globalNilNode;
-
-    while (globalCheck != &tree->globalNilNode) {
-      globalCur = globalCheck;
-
-      globalCheck = (entryEndAddress < GetEntryEndAddress(globalCheck))
-        ? globalCheck->left : globalCheck->right;
-    }
-
-    if (globalCur != &tree->globalNilNode) {
-      if (DoEntriesOverlap(node, globalCur))
-        return 1;
-    }
-  }
-
-  /* Insert the entry. */
+  /* Insert the entry. Overlapping entries are kept, as in TLBMatch; */
+  /* software has to replace one of them before it relies on either. */
   if (cur != nil) {
-    if (IsGlobalEntry(node) || DoASIDsMatch(node, cur))
-      if (DoEntriesOverlap(node, cur))
-        return 1;
-
-    if (entryEndAddress < GetEntryEndAddress(cur))
+    if (SortsBefore(node, cur))
       cur->left = node;
     else
       cur->right = node;
@@ -487,19 +478,8 @@ TLBTreeLookup(const struct TLBTree *tree, uint8_t asid, uint64_t address) {
   if ((node = SearchTree(tree->globalEntryRoot, &tree->globalNilNode, vpn2)))
     return node;
 
-  node = tree->asidEntryRoot;
-
-  /* Otherwise, start walking down the ASIDs of the other subtree. */
-  while (node != &tree->asidNilNode && asid != node->tlbEntryHi.asid) {
-    node = (asid < node->tlbEntryHi.asid)
-      ? node->left : node->right;
-  }
-
-  /* Search the part of the tree with the same ASIDs. */
-  if ((node = SearchTree(node, &tree->asidNilNode, vpn2)))
-    return node;
-
-  return NULL;
+  /* Otherwise, search the entries with the same ASID. */
+  return SearchASIDTree(tree->asidEntryRoot, &tree->asidNilNode, asid, vpn2);
 }
 
 /* ============================================================================
@@ -0,0 +1,78 @@
+/* ============================================================================
+ *  Decoder.c: Flattened opcode table against the escape tables (make check).
+ *
+ *  C++ builds decode through a table flattened from the escape tables at
+ *  compile time. Decodes every instruction word both ways and checks that
+ *  each gives the same opcode id and flags.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+
+/* Pulled in whole, to get at the (static) escape tables. */
+#include "../Decoder.c"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+/* Mismatches reported before giving up on the rest. */
+#define MAX_REPORTED 16
+
+static const struct VR4300Opcode *DecodeEscaped(uint32_t);
+
+/* ============================================================================
+ *  DecodeEscaped: Decodes an instruction through the escape tables, as C
+ *  builds of VR4300DecodeInstruction do.
+ * ========================================================================= */
+static const struct VR4300Opcode *
+DecodeEscaped(uint32_t iw) {
+  const struct VR4300OpcodeEscape *escape = &EscapeTable[iw >> 26];
+  unsigned index = iw >> escape->shift & escape->mask;
+
+  return SpecializeOpcode(iw, &escape->table[index]);
+}
+
+/* ============================================================================
+ *  main: Compares the two over all 2^32 instruction words.
+ * ========================================================================= */
+int
+main(void) {
+  unsigned long long checked = 0;
+  unsigned mismatches = 0;
+  uint32_t iw = 0;
+
+#ifndef __cplusplus
+  printf("Decoder: skipped (the flattened table is C++ only).\n");
+  return EXIT_SUCCESS;
+#endif
+
+  do {
+    const struct VR4300Opcode *flat = VR4300DecodeInstruction(iw);
+    const struct VR4300Opcode *escaped = DecodeEscaped(iw);
+
+    if (flat->id != escaped->id || flat->flags != escaped->flags) {
+      fprintf(stderr, "0x%.8X: flat %u/0x%X, escaped %u/0x%X.\n",
+        (unsigned) iw, (unsigned) flat->id, (unsigned) flat->flags,
+        (unsigned) escaped->id, (unsigned) escaped->flags);
+
+      if (++mismatches == MAX_REPORTED)
+        break;
+    }
+
+    checked++;
+  } while (++iw != 0);
+
+  printf("Decoder: %llu instruction words, %s.\n", checked,
+    mismatches ? "FAILED" : "passed");
+
+  return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
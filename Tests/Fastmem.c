@@ -0,0 +1,152 @@
+/* ============================================================================
+ *  Fastmem.c: Fault routing between fastmem instances (make check).
+ *
+ *  Each instance has a window of its own, and accesses that fault in it
+ *  (MMIO) must reach that instance's devices. Checks that they do with two
+ *  instances at once, and that the survivor still works once the other
+ *  has been destroyed.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "BusPolicy.h"
+#include "CPU.h"
+#include "Externs.h"
+#include "PageTable.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+/* Where each instance's device sits; memory is mapped below it. */
+#define MMIO_ADDRESS 0x04600000U
+
+static bool CheckWrites(const char *, const unsigned *,
+  unsigned, unsigned);
+static int CountWrite(void *, uint32_t, void *);
+static bool StoreWord(const struct VR4300 *, uint32_t, uint32_t);
+
+/* Word writes are counted in the instance's own counter (the opaque). */
+static const struct VR4300PageHandlers DeviceHandlers = {
+  {NULL, NULL, NULL, NULL, NULL},
+  {NULL, NULL, CountWrite, NULL, NULL}
+};
+
+/* ============================================================================
+ *  Bus: Nothing should get this far; devices are mapped in directly.
+ * ========================================================================= */
+MemoryFunction
+BusRead(const struct BusController *unused(bus), unsigned unused(type),
+  uint32_t unused(address), void **opaque) {
+  *opaque = NULL;
+  return NULL;
+}
+
+MemoryFunction
+BusWrite(const struct BusController *unused(bus), unsigned unused(type),
+  uint32_t unused(address), void **opaque) {
+  *opaque = NULL;
+  return NULL;
+}
+
+uint32_t
+BusReadWord(const struct BusController *unused(bus),
+  uint32_t unused(address)) {
+  return 0;
+}
+
+/* ============================================================================
+ *  CheckWrites: Reports whether each device saw the writes it should have.
+ * ========================================================================= */
+static bool
+CheckWrites(const char *name, const unsigned *writes,
+  unsigned first, unsigned second) {
+  if (writes[0] == first && writes[1] == second)
+    return true;
+
+  fprintf(stderr, "%s: devices saw %u and %u writes, expected %u and %u.\n",
+    name, writes[0], writes[1], first, second);
+
+  return false;
+}
+
+/* ============================================================================
+ *  CountWrite: Stands in for a device register.
+ * ========================================================================= */
+static int
+CountWrite(void *opaque, uint32_t unused(address),
+  void *unused(contents)) {
+  ++*(unsigned*) opaque;
+  return 0;
+}
+
+/* ============================================================================
+ *  StoreWord: Does an uncached SW.
+ * ========================================================================= */
+static bool
+StoreWord(const struct VR4300 *vr4300, uint32_t address, uint32_t word) {
+  return VR4300PageBusWrite(&vr4300->pageTable,
+    BUS_TYPE_WORD, address, &word);
+}
+
+/* ============================================================================
+ *  main: Runs each case, if the host has fastmem at all.
+ * ========================================================================= */
+int
+main(void) {
+  struct VR4300 *first, *second;
+  unsigned writes[2] = {0, 0};
+  bool passed = true;
+
+  first = CreateVR4300(VR4300_CREATE_FASTMEM);
+  second = CreateVR4300(VR4300_CREATE_FASTMEM);
+
+  if (first == NULL || second == NULL) {
+    fprintf(stderr, "Failed to create a VR4300.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (first->pageTable.fastmem == NULL) {
+    printf("Fastmem: skipped (unavailable on this host).\n");
+    DestroyVR4300(first);
+    DestroyVR4300(second);
+    return EXIT_SUCCESS;
+  }
+
+  if (second->pageTable.fastmem == NULL) {
+    fprintf(stderr, "Fastmem: a second instance couldn't have it.\n");
+    DestroyVR4300(first);
+    DestroyVR4300(second);
+    return EXIT_FAILURE;
+  }
+
+  VR4300MapDevicePages(first, MMIO_ADDRESS,
+    VR4300_PAGE_SIZE, &DeviceHandlers, &writes[0]);
+  VR4300MapDevicePages(second, MMIO_ADDRESS,
+    VR4300_PAGE_SIZE, &DeviceHandlers, &writes[1]);
+
+  /* Both instances at once. */
+  StoreWord(first, MMIO_ADDRESS, 0x1);
+  StoreWord(second, MMIO_ADDRESS, 0x1);
+  StoreWord(second, MMIO_ADDRESS, 0x1);
+  passed &= CheckWrites("Two instances", writes, 1, 2);
+
+  /* Only the second, once the first has given its window back. */
+  DestroyVR4300(first);
+  StoreWord(second, MMIO_ADDRESS, 0x1);
+  passed &= CheckWrites("After destroying one", writes, 1, 3);
+
+  printf("Fastmem: %s.\n", passed ? "passed" : "FAILED");
+
+  DestroyVR4300(second);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,195 @@
+/* ============================================================================
+ *  WriteBuffer.c: Ordering of buffered partial stores (make check).
+ *
+ *  Uncached partial stores (SWL, SWR, ...) wait in the write buffer, while
+ *  everything else may go straight to memory through fastmem. Checks that
+ *  later loads and stores, and MMIO writes, all see them land first.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "BusPolicy.h"
+#include "CPU.h"
+#include "Externs.h"
+#include "PageTable.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/* Where MMIO writes go; nothing is mapped there. */
+#define MMIO_ADDRESS 0x04600000U
+
+static bool CheckWord(const char *, uint32_t, uint32_t);
+static uint32_t LoadWord(const struct VR4300PageTable *, uint32_t);
+static uint32_t PeekWord(uint32_t);
+static void StorePartial(const struct VR4300PageTable *, uint32_t,
+  uint8_t, uint8_t);
+static void StoreWord(const struct VR4300PageTable *, uint32_t, uint32_t);
+static int WriteMMIO(void *, uint32_t, void *);
+
+/* Memory at physical address 0 (big-endian byte order). */
+static uint8_t *RDRAM;
+
+/* What memory held at 0x300 when the MMIO write arrived. */
+static uint32_t WordAtMMIOWrite;
+
+/* ============================================================================
+ *  Bus: Only MMIO accesses get this far; memory is mapped in directly.
+ * ========================================================================= */
+MemoryFunction
+BusRead(const struct BusController *unused(bus), unsigned unused(type),
+  uint32_t unused(address), void **opaque) {
+  *opaque = NULL;
+  return NULL;
+}
+
+MemoryFunction
+BusWrite(const struct BusController *unused(bus), unsigned unused(type),
+  uint32_t address, void **opaque) {
+  *opaque = NULL;
+  return address == MMIO_ADDRESS ? WriteMMIO : NULL;
+}
+
+uint32_t
+BusReadWord(const struct BusController *unused(bus),
+  uint32_t unused(address)) {
+  return 0;
+}
+
+/* ============================================================================
+ *  CheckWord: Reports whether a word came out as expected.
+ * ========================================================================= */
+static bool
+CheckWord(const char *name, uint32_t word, uint32_t expected) {
+  if (word == expected)
+    return true;
+
+  fprintf(stderr, "%s: got 0x%.8X, expected 0x%.8X.\n",
+    name, (unsigned) word, (unsigned) expected);
+
+  return false;
+}
+
+/* ============================================================================
+ *  LoadWord: Does an uncached LW.
+ * ========================================================================= */
+static uint32_t
+LoadWord(const struct VR4300PageTable *pages, uint32_t address) {
+  uint32_t word = 0;
+
+  VR4300PageBusRead(pages, BUS_TYPE_WORD, address, &word);
+  return word;
+}
+
+/* ============================================================================
+ *  PeekWord: Returns a word as memory holds it right now.
+ * ========================================================================= */
+static uint32_t
+PeekWord(uint32_t address) {
+  uint32_t word;
+
+  memcpy(&word, RDRAM + address, sizeof(word));
+  return ByteOrderSwap32(word);
+}
+
+/* ============================================================================
+ *  StorePartial: Does an uncached SWL of two bytes (i.e., to the last two
+ *  bytes of a word), the way DC hands those to the bus.
+ * ========================================================================= */
+static void
+StorePartial(const struct VR4300PageTable *pages,
+  uint32_t address, uint8_t first, uint8_t second) {
+  struct UnalignedData data;
+
+  memset(&data, 0, sizeof(data));
+  data.data[0] = first;
+  data.data[1] = second;
+  data.size = 2;
+
+  VR4300PageBusWrite(pages, BUS_TYPE_UWORD, address, &data);
+}
+
+/* ============================================================================
+ *  StoreWord: Does an uncached SW.
+ * ========================================================================= */
+static void
+StoreWord(const struct VR4300PageTable *pages,
+  uint32_t address, uint32_t word) {
+  VR4300PageBusWrite(pages, BUS_TYPE_WORD, address, &word);
+}
+
+/* ============================================================================
+ *  WriteMMIO: Stands in for a register write that would start a DMA.
+ * ========================================================================= */
+static int
+WriteMMIO(void *unused(opaque), uint32_t unused(address),
+  void *unused(contents)) {
+  WordAtMMIOWrite = PeekWord(0x300);
+  return 0;
+}
+
+/* ============================================================================
+ *  main: Runs each case, with fastmem if the host has it.
+ * ========================================================================= */
+int
+main(void) {
+  const struct VR4300PageTable *pages;
+  struct VR4300 *vr4300;
+  uint8_t *memory = NULL;
+  bool passed = true;
+
+  if ((vr4300 = CreateVR4300(VR4300_CREATE_FASTMEM)) == NULL) {
+    fprintf(stderr, "Failed to create a VR4300.\n");
+    return EXIT_FAILURE;
+  }
+
+  if ((RDRAM = VR4300MapFastmemPages(vr4300,
+    0, VR4300_PAGE_SIZE, true)) == NULL) {
+    if ((RDRAM = memory = (uint8_t*) calloc(1, VR4300_PAGE_SIZE)) == NULL) {
+      fprintf(stderr, "Failed to allocate memory.\n");
+      DestroyVR4300(vr4300);
+      return EXIT_FAILURE;
+    }
+
+    VR4300MapHostPages(vr4300, 0, VR4300_PAGE_SIZE, RDRAM, true);
+  }
+
+  pages = &vr4300->pageTable;
+
+  /* SWL, then LW of the same word. */
+  StoreWord(pages, 0x100, 0x11223344);
+  StorePartial(pages, 0x102, 0xAA, 0xBB);
+  passed &= CheckWord("SWL then LW", LoadWord(pages, 0x100), 0x1122AABB);
+
+  /* SWL, then SW over the same bytes; the SW must win, even once */
+  /* whatever is still buffered has gone out. */
+  StorePartial(pages, 0x202, 0xAA, 0xBB);
+  StoreWord(pages, 0x200, 0x55667788);
+  VR4300DrainWriteBuffer(pages);
+  passed &= CheckWord("SWL then SW", PeekWord(0x200), 0x55667788);
+
+  /* SWL, then an MMIO write that could start a DMA from it. */
+  StoreWord(pages, 0x300, 0x11223344);
+  StorePartial(pages, 0x302, 0xCC, 0xDD);
+  StoreWord(pages, MMIO_ADDRESS, 0x1);
+  passed &= CheckWord("SWL then MMIO", WordAtMMIOWrite, 0x1122CCDD);
+
+  printf("WriteBuffer (%s): %s.\n", pages->fastmem != NULL
+    ? "fastmem" : "page table", passed ? "passed" : "FAILED");
+
+  DestroyVR4300(vr4300);
+  free(memory);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
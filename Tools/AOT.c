@@ -0,0 +1,79 @@
+/* ============================================================================
+ *  AOT.c: Static recompiler driver.
+ *
+ *  Usage: vr4300aot <image> <physical base> <entry point>... > code.c
+ *
+ *  Writes out C for the code reachable from the entry points in a raw,
+ *  big-endian code image. Compile the result into a shared object (see
+ *  the Makefile's %.so rule) and hand it to VR4300LoadStaticCode.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "StaticRecompiler.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+/* ============================================================================
+ *  main: Reads the image and writes the C to stdout.
+ * ========================================================================= */
+int
+main(int argc, const char *argv[]) {
+  uint32_t base, *entries, size;
+  unsigned i, numRuns;
+  uint8_t *image;
+  FILE *file;
+  long length;
+
+  if (argc < 4) {
+    fprintf(stderr, "Usage: %s <image> <physical base> <entry point>...\n",
+      argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if ((file = fopen(argv[1], "rb")) == NULL) {
+    fprintf(stderr, "Failed to open: %s.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  fseek(file, 0, SEEK_END);
+  length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  size = length > 0 ? (uint32_t) length & ~0x3U : 0;
+
+  if ((image = (uint8_t*) malloc(size + 4)) == NULL ||
+    fread(image, 1, size, file) != size) {
+    fprintf(stderr, "Failed to read: %s.\n", argv[1]);
+    fclose(file);
+    return EXIT_FAILURE;
+  }
+
+  fclose(file);
+
+  if ((entries = (uint32_t*) malloc(sizeof(*entries) * (argc - 3))) == NULL)
+    return EXIT_FAILURE;
+
+  base = strtoul(argv[2], NULL, 0);
+
+  for (i = 0; i < (unsigned) argc - 3; i++)
+    entries[i] = strtoul(argv[i + 3], NULL, 0);
+
+  numRuns = VR4300WriteStaticCode(stdout, image, size, base, entries, i);
+  fprintf(stderr, "Wrote %u runs.\n", numRuns);
+
+  free(entries);
+  free(image);
+  return EXIT_SUCCESS;
+}
+
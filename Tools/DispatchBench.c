@@ -0,0 +1,263 @@
+/* ============================================================================
+ *  DispatchBench.c: Cached interpreter dispatch benchmark (make bench).
+ *
+ *  Runs a loop of mixed ALU, load/store and branch instructions through
+ *  VR4300RunCached, and reports the time and host branch mispredicts per
+ *  guest cycle (an instruction, plus any interlock stalls). Build with and
+ *  without -DUSE_COMPUTED_GOTO to see what threaded dispatch does. The
+ *  mispredicts come from Linux's perf_event_open, where the host allows.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "Common.h"
+#include "BlockCache.h"
+#include "CPU.h"
+#include "Externs.h"
+#include "PageTable.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Cycles run before timing starts, and in each timed run. The fastest */
+/* of the runs is reported, as hosts are seldom quiet. */
+#define WARMUP_CYCLES 1000000ULL
+#define TIMED_CYCLES 10000000ULL
+#define TIMED_RUNS 5
+
+/* Where the loop is fetched from (the reset vector), and RDRAM. */
+#define ROM_ADDRESS 0x1FC00000U
+#define RDRAM_ADDRESS 0x00000000U
+
+/* Instruction encodings, and the registers the loop uses. */
+#define R_TYPE(rs, rt, rd, sa, funct) \
+  ((uint32_t) (rs) << 21 | (uint32_t) (rt) << 16 | \
+   (uint32_t) (rd) << 11 | (uint32_t) (sa) << 6 | (funct))
+#define I_TYPE(op, rs, rt, imm) \
+  ((uint32_t) (op) << 26 | (uint32_t) (rs) << 21 | \
+   (uint32_t) (rt) << 16 | ((imm) & 0xFFFF))
+
+enum Register {
+  ZERO = 0, T0 = 8, T1, T2, T3, T4, T5, T6, T7,
+  S0, S1, S2, S3, S4, S5, S6, S7, T8, T9
+};
+
+static void CloseCounter(int);
+static double GetTime(void);
+static int OpenCounter(void);
+static long long ReadCounter(int);
+static void StartCounter(int);
+
+/* Counts up forever; every opcode in the body is a different one. */
+static const uint32_t Loop[] = {
+  I_TYPE(0x0F, ZERO, T0, 0xA000),     /* lui   t0, 0xA000 */
+  I_TYPE(0x09, ZERO, T1, 0),          /* addiu t1, zero, 0 */
+  I_TYPE(0x09, T1, T1, 1),            /* loop: addiu t1, t1, 1 */
+  R_TYPE(T2, T1, T2, 0, 0x21),        /* addu  t2, t2, t1 */
+  R_TYPE(T2, T1, T3, 0, 0x26),        /* xor   t3, t2, t1 */
+  R_TYPE(ZERO, T3, T4, 3, 0x00),      /* sll   t4, t3, 3 */
+  R_TYPE(ZERO, T4, T5, 5, 0x02),      /* srl   t5, t4, 5 */
+  R_TYPE(ZERO, T2, T6, 7, 0x03),      /* sra   t6, t2, 7 */
+  R_TYPE(T4, T5, T7, 0, 0x27),        /* nor   t7, t4, t5 */
+  R_TYPE(T5, T4, S0, 0, 0x2A),        /* slt   s0, t5, t4 */
+  R_TYPE(T4, T5, S1, 0, 0x2B),        /* sltu  s1, t4, t5 */
+  I_TYPE(0x0C, T3, S2, 0xF0F0),       /* andi  s2, t3, 0xF0F0 */
+  I_TYPE(0x0E, T3, S3, 0x8001),       /* xori  s3, t3, 0x8001 */
+  I_TYPE(0x0D, T2, S4, 0x1234),       /* ori   s4, t2, 0x1234 */
+  R_TYPE(T2, T3, S5, 0, 0x24),        /* and   s5, t2, t3 */
+  R_TYPE(S5, T4, S6, 0, 0x25),        /* or    s6, s5, t4 */
+  R_TYPE(S6, T1, S7, 0, 0x23),        /* subu  s7, s6, t1 */
+  I_TYPE(0x2B, T0, S7, 0x100),        /* sw    s7, 0x100(t0) */
+  I_TYPE(0x23, T0, T8, 0x100),        /* lw    t8, 0x100(t0) */
+  R_TYPE(T8, T7, T9, 0, 0x04),        /* sllv  t9, t7, t8 */
+  I_TYPE(0x29, T0, T9, 0x104),        /* sh    t9, 0x104(t0) */
+  I_TYPE(0x24, T0, T6, 0x105),        /* lbu   t6, 0x105(t0) */
+  R_TYPE(T2, T6, T2, 0, 0x21),        /* addu  t2, t2, t6 */
+  I_TYPE(0x05, T1, ZERO, -22),        /* bne   t1, zero, loop */
+  0                                   /* nop */
+};
+
+/* ============================================================================
+ *  Bus: Only unmapped addresses get this far, and the loop touches none.
+ * ========================================================================= */
+MemoryFunction
+BusRead(const struct BusController *unused(bus), unsigned unused(type),
+  uint32_t unused(address), void **opaque) {
+  *opaque = NULL;
+  return NULL;
+}
+
+MemoryFunction
+BusWrite(const struct BusController *unused(bus), unsigned unused(type),
+  uint32_t unused(address), void **opaque) {
+  *opaque = NULL;
+  return NULL;
+}
+
+uint32_t
+BusReadWord(const struct BusController *unused(bus),
+  uint32_t unused(address)) {
+  return 0;
+}
+
+/* ============================================================================
+ *  Counter: Host branch mispredicts in this thread (user mode only). The
+ *  descriptor is negative where they can't be counted.
+ * ========================================================================= */
+#ifdef __linux__
+static void
+CloseCounter(int fd) {
+  if (fd >= 0)
+    close(fd);
+}
+
+static int
+OpenCounter(void) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long long
+ReadCounter(int fd) {
+  long long count;
+
+  if (fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+    return -1;
+
+  return count;
+}
+
+static void
+StartCounter(int fd) {
+  if (fd < 0)
+    return;
+
+  ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+  ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+#else
+static void
+CloseCounter(int unused(fd)) {
+}
+
+static int
+OpenCounter(void) {
+  return -1;
+}
+
+static long long
+ReadCounter(int unused(fd)) {
+  return -1;
+}
+
+static void
+StartCounter(int unused(fd)) {
+}
+#endif
+
+/* ============================================================================
+ *  GetTime: Returns a monotonic time, in seconds.
+ * ========================================================================= */
+static double
+GetTime(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* ============================================================================
+ *  main: Runs the loop, and reports what it cost.
+ * ========================================================================= */
+int
+main(void) {
+  static uint8_t rom[VR4300_PAGE_SIZE], rdram[VR4300_PAGE_SIZE];
+  unsigned long long ran = 0;
+  double start, time, best = 0;
+  long long count, misses = -1;
+  struct VR4300 *vr4300;
+  unsigned i, run;
+  int fd;
+
+  for (i = 0; i < sizeof(Loop) / sizeof(*Loop); i++) {
+    uint32_t word = ByteOrderSwap32(Loop[i]);
+    memcpy(rom + (i << 2), &word, sizeof(word));
+  }
+
+  if ((vr4300 = CreateVR4300(0)) == NULL) {
+    fprintf(stderr, "Failed to create a VR4300.\n");
+    return EXIT_FAILURE;
+  }
+
+  VR4300MapHostPages(vr4300, ROM_ADDRESS, sizeof(rom), rom, false);
+  VR4300MapHostPages(vr4300, RDRAM_ADDRESS, sizeof(rdram), rdram, true);
+  VR4300RunCached(vr4300, WARMUP_CYCLES);
+  fd = OpenCounter();
+
+  for (run = 0; run < TIMED_RUNS; run++) {
+    StartCounter(fd);
+    start = GetTime();
+
+    ran = VR4300RunCached(vr4300, TIMED_CYCLES);
+
+    time = GetTime() - start;
+    count = ReadCounter(fd);
+
+    if (run == 0 || time < best) {
+      best = time;
+      misses = count;
+    }
+  }
+
+  CloseCounter(fd);
+
+  printf("Cached interpreter dispatch (%s): %u runs of %llu cycles.\n",
+#if defined(USE_COMPUTED_GOTO) && defined(__GNUC__)
+    "threaded", TIMED_RUNS, ran);
+#else
+    "function table", TIMED_RUNS, ran);
+#endif
+
+  printf("  %6.2f ns/cycle.\n", best * 1e9 / ran);
+
+  if (misses >= 0)
+    printf("  %6.3f branch mispredicts/cycle.\n",
+      (double) misses / ran);
+  else
+    printf("  Branch mispredicts can't be counted on this host.\n");
+
+  DestroyVR4300(vr4300);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+/* ============================================================================
+ *  TLBBench.c: TLB lookup benchmark (make bench).
+ *
+ *  Fills all 32 entries of both TLB backends the same way, then times
+ *  TLBMatchLookup against TLBTreeLookup over the same stream of addresses
+ *  (mostly hits, spread over global and ASID entries, and some misses).
+ *  Fails if the two backends don't return the same entry for every one.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include "Common.h"
+#include "TLBMatch.h"
+#include "TLBTree.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+/* Addresses in the stream, and how many times it's walked. */
+#define NUM_ADDRESSES 4096
+#define NUM_PASSES 4096
+
+/* Every eighth address misses; the rest pick an entry at random. */
+#define MISS_INTERVAL 8
+
+/* The ASID that most lookups are done under. */
+#define LOOKUP_ASID 0x11
+
+struct Lookup {
+  uint64_t address;
+  uint8_t asid;
+};
+
+static void FillEntries(struct TLBMatch *, struct TLBTree *, unsigned);
+static double GetTime(void);
+static void MakeLookups(struct Lookup *);
+static uint32_t NextRandom(uint32_t *);
+
+/* ============================================================================
+ *  FillEntries: Writes the same 32 entries into both backends, the way
+ *  TLBWI does. Even entries are global; odd ones belong to an ASID (half
+ *  of them the one mostly looked up under). Page sizes vary from 4KiB to
+ *  64KiB. Each round places the entries differently, and replaces (and so
+ *  evicts from the tree) whatever the previous round wrote.
+ * ========================================================================= */
+static void
+FillEntries(struct TLBMatch *match, struct TLBTree *tree, unsigned round) {
+  unsigned i;
+
+  for (i = 0; i < NUM_TLB_ENTRIES; i++) {
+    struct TLBMatchEntry *matchEntry = match->entries + i;
+    struct TLBNode *node = tree->entries + i;
+    struct EntryLo entryLo;
+    struct EntryHi entryHi;
+    unsigned slot = (i + round * 5) % NUM_TLB_ENTRIES;
+    uint16_t pageMask;
+
+    pageMask = (i & 0x2) ? 0x000F : 0x0000;
+
+    memset(&entryHi, 0, sizeof(entryHi));
+    entryHi.vpn2 = (0x100 + (slot << 4)) & ~(uint32_t) pageMask;
+    entryHi.asid = (i & 0x1) ? ((i & 0x4) ? LOOKUP_ASID : i) : 0;
+
+    memset(&entryLo, 0, sizeof(entryLo));
+    entryLo.pfn = i << 8;
+    entryLo.global = !(i & 0x1);
+    entryLo.valid = 1;
+
+    memcpy(&matchEntry->tlbEntryLo0, &entryLo, sizeof(entryLo));
+    memcpy(&matchEntry->tlbEntryLo1, &entryLo, sizeof(entryLo));
+    memcpy(&matchEntry->tlbEntryHi, &entryHi, sizeof(entryHi));
+    matchEntry->pageMask = pageMask;
+    TLBMatchUpdate(match, matchEntry);
+
+    TLBTreeEvict(tree, node);
+    memcpy(&node->tlbEntryLo0, &entryLo, sizeof(entryLo));
+    memcpy(&node->tlbEntryLo1, &entryLo, sizeof(entryLo));
+    memcpy(&node->tlbEntryHi, &entryHi, sizeof(entryHi));
+    node->pageMask = pageMask;
+    TLBTreeInsert(tree, node);
+  }
+}
+
+/* ============================================================================
+ *  GetTime: Returns a monotonic time, in seconds.
+ * ========================================================================= */
+static double
+GetTime(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* ============================================================================
+ *  MakeLookups: Generates the (same every run) stream of addresses.
+ * ========================================================================= */
+static void
+MakeLookups(struct Lookup *lookups) {
+  uint32_t seed = 0x2545F491;
+  unsigned i;
+
+  for (i = 0; i < NUM_ADDRESSES; i++) {
+    uint32_t random = NextRandom(&seed);
+    uint32_t vpn2 = 0x100 + ((random % NUM_TLB_ENTRIES) << 4);
+
+    /* Nothing is mapped this far up. */
+    if (i % MISS_INTERVAL == 0)
+      vpn2 += 0x10000;
+
+    lookups[i].address = (uint64_t) vpn2 << 13 | (random >> 8 & 0x1FFF);
+    lookups[i].asid = (random & 0x3) ? LOOKUP_ASID : random >> 27;
+  }
+}
+
+/* ============================================================================
+ *  NextRandom: Steps a xorshift generator.
+ * ========================================================================= */
+static uint32_t
+NextRandom(uint32_t *state) {
+  uint32_t x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* ============================================================================
+ *  main: Times each backend, and checks that they agree.
+ * ========================================================================= */
+int
+main(void) {
+  static struct Lookup lookups[NUM_ADDRESSES];
+  static struct TLBMatch match;
+  static struct TLBTree tree;
+
+  unsigned i, pass, matchHits = 0, treeHits = 0, disagreements = 0;
+  double start, matchTime, treeTime;
+  volatile uintptr_t sink = 0;
+
+  InitTLBMatch(&match);
+  InitTLBTree(&tree);
+
+  FillEntries(&match, &tree, 0);
+  FillEntries(&match, &tree, 1);
+  MakeLookups(lookups);
+
+  for (i = 0; i < NUM_ADDRESSES; i++) {
+    const struct TLBMatchEntry *matchEntry = TLBMatchLookup(
+      &match, lookups[i].asid, lookups[i].address);
+    const struct TLBNode *node = TLBTreeLookup(
+      &tree, lookups[i].asid, lookups[i].address);
+
+    matchHits += matchEntry != NULL;
+    treeHits += node != NULL;
+
+    if ((matchEntry ? matchEntry - match.entries : -1) !=
+      (node ? node - tree.entries : -1))
+      disagreements++;
+  }
+
+  start = GetTime();
+
+  for (pass = 0; pass < NUM_PASSES; pass++) {
+    for (i = 0; i < NUM_ADDRESSES; i++)
+      sink += (uintptr_t) TLBMatchLookup(
+        &match, lookups[i].asid, lookups[i].address);
+  }
+
+  matchTime = GetTime() - start;
+  start = GetTime();
+
+  for (pass = 0; pass < NUM_PASSES; pass++) {
+    for (i = 0; i < NUM_ADDRESSES; i++)
+      sink += (uintptr_t) TLBTreeLookup(
+        &tree, lookups[i].asid, lookups[i].address);
+  }
+
+  treeTime = GetTime() - start;
+
+  printf("TLB lookups: %u addresses x %u passes.\n",
+    NUM_ADDRESSES, NUM_PASSES);
+  printf("  TLBMatch: %6.2f ns/lookup, %u/%u hits.\n", matchTime * 1e9 /
+    ((double) NUM_ADDRESSES * NUM_PASSES), matchHits, NUM_ADDRESSES);
+  printf("  TLBTree:  %6.2f ns/lookup, %u/%u hits.\n", treeTime * 1e9 /
+    ((double) NUM_ADDRESSES * NUM_PASSES), treeHits, NUM_ADDRESSES);
+  printf("  Backends disagree on %u addresses.\n", disagreements);
+
+  return disagreements ? EXIT_FAILURE : EXIT_SUCCESS;
+}
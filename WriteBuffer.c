@@ -0,0 +1,216 @@
+/* ============================================================================
+ *  WriteBuffer.c: Coalescing write buffer for uncached stores.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "Externs.h"
+#include "PageTable.h"
+#include "WriteBuffer.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+static unsigned RetireEntry(const struct VR4300PageTable *,
+  const struct VR4300WriteBufferEntry *);
+static void WriteChunk(const struct VR4300PageTable *,
+  uint32_t, const uint8_t *, unsigned);
+
+/* ============================================================================
+ *  RetireEntry: Writes out an entry using as few bus transactions as the
+ *  bytes in it allow; returns the number of transactions that took.
+ * ========================================================================= */
+static unsigned
+RetireEntry(const struct VR4300PageTable *pages,
+  const struct VR4300WriteBufferEntry *entry) {
+  unsigned offset, size, transactions = 0;
+
+  if (entry->mask == 0xFFFF) {
+    VR4300WriteLine(pages, entry->address,
+      entry->data, sizeof(entry->data));
+
+    return 1;
+  }
+
+  for (offset = 0; offset < sizeof(entry->data); offset += size) {
+    unsigned bits = entry->mask >> offset;
+
+    if (!(bits & 0x1)) {
+      size = 1;
+      continue;
+    }
+
+    /* Largest naturally aligned run of buffered bytes from here. */
+    for (size = 8; size > 1; size >>= 1) {
+      if (!(offset & (size - 1)) && (bits & ((1U << size) - 1)) ==
+        (1U << size) - 1)
+        break;
+    }
+
+    WriteChunk(pages, entry->address + offset, entry->data + offset, size);
+    transactions++;
+  }
+
+  return transactions;
+}
+
+/* ============================================================================
+ *  WriteChunk: Writes a naturally aligned byte, halfword, word or
+ *  doubleword (given in big-endian byte order) through the page table.
+ * ========================================================================= */
+static void
+WriteChunk(const struct VR4300PageTable *pages,
+  uint32_t address, const uint8_t *data, unsigned size) {
+  MemoryFunction write;
+  unsigned type;
+  void *opaque;
+
+  uint16_t hword;
+  uint32_t word;
+  uint64_t dword;
+  uint8_t byte;
+  void *contents;
+
+  switch (size) {
+    case 1:
+      memcpy(&byte, data, sizeof(byte));
+      type = BUS_TYPE_BYTE;
+      contents = &byte;
+      break;
+
+    case 2:
+      memcpy(&hword, data, sizeof(hword));
+      hword = ByteOrderSwap16(hword);
+      type = BUS_TYPE_HWORD;
+      contents = &hword;
+      break;
+
+    case 4:
+      memcpy(&word, data, sizeof(word));
+      word = ByteOrderSwap32(word);
+      type = BUS_TYPE_WORD;
+      contents = &word;
+      break;
+
+    default:
+      memcpy(&dword, data, sizeof(dword));
+      dword = ByteOrderSwap64(dword);
+      type = BUS_TYPE_DWORD;
+      contents = &dword;
+      break;
+  }
+
+  if ((write = VR4300PageWrite(pages, type, address, &opaque)) != NULL)
+    write(opaque, address, contents);
+}
+
+/* ============================================================================
+ *  VR4300BufferStore: Queues an uncached store to memory, merging it into
+ *  an entry for the same block where possible. Contents are in host byte
+ *  order, or a struct UnalignedData for BUS_TYPE_UWORD/BUS_TYPE_UDWORD.
+ * ========================================================================= */
+void
+VR4300BufferStore(const struct VR4300PageTable *pages,
+  unsigned type, uint32_t address, const void *contents) {
+  struct VR4300WriteBuffer *buffer = pages->writeBuffer;
+  struct VR4300WriteBufferEntry *entry = NULL;
+  uint32_t block = address & ~VR4300_WRITE_BUFFER_BLOCK_MASK;
+  const struct UnalignedData *unaligned;
+  unsigned i, offset, size;
+  uint8_t data[8];
+
+  uint16_t hword;
+  uint32_t word;
+  uint64_t dword;
+
+  switch (type) {
+    case BUS_TYPE_BYTE:
+      memcpy(data, contents, sizeof(uint8_t));
+      size = 1;
+      break;
+
+    case BUS_TYPE_HWORD:
+      memcpy(&hword, contents, sizeof(hword));
+      hword = ByteOrderSwap16(hword);
+      memcpy(data, &hword, sizeof(hword));
+      size = 2;
+      break;
+
+    case BUS_TYPE_WORD:
+      memcpy(&word, contents, sizeof(word));
+      word = ByteOrderSwap32(word);
+      memcpy(data, &word, sizeof(word));
+      size = 4;
+      break;
+
+    case BUS_TYPE_DWORD:
+      memcpy(&dword, contents, sizeof(dword));
+      dword = ByteOrderSwap64(dword);
+      memcpy(data, &dword, sizeof(dword));
+      size = 8;
+      break;
+
+    /* Partial stores never cross the (naturally aligned) unit. */
+    default:
+      unaligned = (const struct UnalignedData*) contents;
+      memcpy(data, unaligned->data, unaligned->size);
+      size = unaligned->size;
+      break;
+  }
+
+  for (i = buffer->count; i > 0; i--) {
+    if (buffer->entries[i - 1].address == block) {
+      entry = &buffer->entries[i - 1];
+      break;
+    }
+  }
+
+  if (entry == NULL) {
+    if (buffer->count == VR4300_WRITE_BUFFER_ENTRIES) {
+      VR4300DrainWriteBuffer(pages);
+      buffer->stalls++;
+    }
+
+    entry = &buffer->entries[buffer->count++];
+    entry->address = block;
+    entry->mask = 0;
+  }
+
+  offset = address & VR4300_WRITE_BUFFER_BLOCK_MASK;
+  memcpy(entry->data + offset, data, size);
+  entry->mask |= ((1U << size) - 1) << offset;
+  buffer->stores++;
+}
+
+/* ============================================================================
+ *  VR4300DrainWriteBuffer: Writes out everything in the write buffer, in
+ *  the order that the entries were allocated.
+ * ========================================================================= */
+void
+VR4300DrainWriteBuffer(const struct VR4300PageTable *pages) {
+  struct VR4300WriteBuffer *buffer = pages->writeBuffer;
+  unsigned i, count = buffer->count;
+
+  /* Line writes check the buffer, too; empty it first. */
+  buffer->count = 0;
+
+  for (i = 0; i < count; i++)
+    buffer->transactions += RetireEntry(pages, &buffer->entries[i]);
+}
+
+/* ============================================================================
+ *  VR4300InitWriteBuffer: Initializes the write buffer. It starts empty.
+ * ========================================================================= */
+void
+VR4300InitWriteBuffer(struct VR4300WriteBuffer *buffer) {
+  memset(buffer, 0, sizeof(*buffer));
+}
+
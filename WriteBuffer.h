@@ -0,0 +1,47 @@
+/* ============================================================================
+ *  WriteBuffer.h: Coalescing write buffer for uncached stores.
+ *
+ *  VR4300SIM: NEC VR43xx Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __VR4300__WRITEBUFFER_H__
+#define __VR4300__WRITEBUFFER_H__
+#include "Common.h"
+
+#define VR4300_WRITE_BUFFER_ENTRIES 4
+
+/* Each entry gathers stores to one (DCache line sized) block. */
+#define VR4300_WRITE_BUFFER_BLOCK_SIZE 16
+#define VR4300_WRITE_BUFFER_BLOCK_MASK (VR4300_WRITE_BUFFER_BLOCK_SIZE - 1)
+
+/* Data is kept in big-endian byte order; one mask bit per byte. */
+struct VR4300WriteBufferEntry {
+  uint8_t data[VR4300_WRITE_BUFFER_BLOCK_SIZE];
+  uint32_t address;
+  uint16_t mask;
+};
+
+struct VR4300WriteBuffer {
+  struct VR4300WriteBufferEntry entries[VR4300_WRITE_BUFFER_ENTRIES];
+  unsigned count;
+
+  /* Stores buffered, bus transactions issued for them, and */
+  /* stores that found the buffer full (and would have stalled). */
+  unsigned long long stores;
+  unsigned long long transactions;
+  unsigned long long stalls;
+};
+
+struct VR4300PageTable;
+
+void VR4300BufferStore(const struct VR4300PageTable *,
+  unsigned, uint32_t, const void *);
+void VR4300DrainWriteBuffer(const struct VR4300PageTable *);
+void VR4300InitWriteBuffer(struct VR4300WriteBuffer *);
+
+#endif
+